@@ -11,9 +11,14 @@
 #include <secp256k1_mlsag.h>
 
 #include <blind.h>
+#include <bloom.h>
+#include <chain.h>
+#include <msgstats.h>
+#include <random.h>
 #include <rctindex.h>
 #include <txdb.h>
 #include <util.h>
+#include <utilmemory.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <consensus/validation.h>
@@ -21,8 +26,78 @@
 #include <txmempool.h>
 
 
-bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
+/** Smallest key image filter built, 1 MiB */
+static const unsigned int MIN_KEY_IMAGE_FILTER_ELEMENTS = 1 << 19;
+/** Largest key image filter built, 2 GiB */
+static const unsigned int MAX_KEY_IMAGE_FILTER_ELEMENTS = 1 << 30;
+
+/**
+ * Holds every key image in the block tree DB, key images erased when blocks
+ * are disconnected stay in it until the next rebuild. Null until loaded, then
+ * a miss saves the DB read. Protected by cs_main.
+ */
+static std::unique_ptr<CBlockedBloomFilter> pKeyImageFilter;
+
+static unsigned int GetKeyImageFilterElements(int64_t nExpected)
 {
+    // Leave room for the chain to grow before the next rebuild
+    return (unsigned int)std::min(std::max(nExpected * 2, (int64_t)MIN_KEY_IMAGE_FILTER_ELEMENTS), (int64_t)MAX_KEY_IMAGE_FILTER_ELEMENTS);
+}
+
+bool LoadKeyImageFilter(int64_t nExpected)
+{
+    AssertLockHeld(cs_main);
+
+    unsigned int nElements = GetKeyImageFilterElements(nExpected);
+
+    int64_t nStart = GetTimeMillis();
+    std::unique_ptr<CBlockedBloomFilter> filter = MakeUnique<CBlockedBloomFilter>(nElements);
+    if (!pblocktree->ForEachRCTKeyImage([&filter](const CCmpPubKey &ki) { filter->insert(ki.begin(), ki.size()); })) {
+        return error("%s: Reading key images failed.", __func__);
+    }
+    pKeyImageFilter = std::move(filter);
+
+    LogPrintf("%s: %u key images, filter for %u using %.1fMiB, %dms\n", __func__,
+        pKeyImageFilter->size(), nElements, pKeyImageFilter->DynamicMemoryUsage() / 1048576.0, GetTimeMillis() - nStart);
+    return true;
+}
+
+void AddKeyImagesToFilter(const std::vector<std::pair<CCmpPubKey, uint256> > &vKeyImages)
+{
+    AssertLockHeld(cs_main);
+
+    if (!pKeyImageFilter) {
+        return;
+    }
+    bool fWasFull = pKeyImageFilter->IsFull();
+    for (const auto &it : vKeyImages) {
+        pKeyImageFilter->insert(it.first.begin(), it.first.size());
+    }
+    if (!pKeyImageFilter->IsFull()) {
+        return;
+    }
+    if (GetKeyImageFilterElements(pKeyImageFilter->size()) > pKeyImageFilter->MaxElements()) {
+        // Keeps the full filter if the rebuild is interrupted, it is still correct
+        LoadKeyImageFilter(pKeyImageFilter->size());
+    } else if (!fWasFull) {
+        // A rebuild at the same size would not help, keep the filter and take the extra DB reads
+        LogPrintf("%s: Key image filter is full at %u elements, false positives will increase.\n", __func__, pKeyImageFilter->MaxElements());
+    }
+}
+
+bool GetSpentKeyImage(const CCmpPubKey &ki, uint256 &txhash)
+{
+    AssertLockHeld(cs_main);
+
+    if (pKeyImageFilter && !pKeyImageFilter->contains(ki.begin(), ki.size())) {
+        return false;
+    }
+    return pblocktree->ReadRCTKeyImage(ki, txhash);
+}
+
+bool VerifyMLSAG(const CTransaction &tx, CValidationState &state, bool fCheckKeyImages)
+{
+    StageTimer timer(ValidationStage::VERIFY_MLSAG);
     int rv;
     std::set<int64_t> setHaveI; // Anon prev-outputs can only be used once per transaction.
     std::set<CCmpPubKey> setHaveKI;
@@ -85,6 +160,8 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
             return state.DoS(100, false, REJECT_MALFORMED, "bad-anonin-sig-size");
 
         std::vector<uint8_t> vM(nCols * nRows * 33);
+        std::vector<uint8_t> vPKH(nCols * nInputs * CAnonOutputPoints::SIZE);
+        bool fHavePoints = true;
 
         std::vector<secp256k1_pedersen_commitment> vCommitments;
         vCommitments.reserve(nCols * nInputs);
@@ -124,6 +201,12 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
                 memcpy(&vM[(i + k * nCols) * 33], ao.pubkey.begin(), 33);
                 vCommitments.push_back(ao.commitment);
                 vpInCommits[i + k * nCols] = vCommitments.back().data;
+
+                // Outputs not yet upgraded fall back to computing the points here
+                if (fHavePoints && (ao.HavePoints() || ao.SetPoints()))
+                    memcpy(&vPKH[(i + k * nCols) * CAnonOutputPoints::SIZE], ao.points.data, CAnonOutputPoints::SIZE);
+                else
+                    fHavePoints = false;
             }
         }
 
@@ -135,11 +218,15 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
                 return state.DoS(100, false, REJECT_INVALID, "bad-anonin-dup-ki");
             }
 
+            if (!fCheckKeyImages) {
+                continue;
+            }
+
             if (mempool.HaveKeyImage(ki, txhashKI) && txhashKI != txhash) {
                 return state.DoS(100, false, REJECT_INVALID, "bad-anonin-dup-ki");
             }
 
-            if (pblocktree->ReadRCTKeyImage(ki, txhashKI) && txhashKI != txhash) {
+            if (GetSpentKeyImage(ki, txhashKI) && txhashKI != txhash) {
                 return state.DoS(100, false, REJECT_INVALID, "bad-anonin-dup-ki");
             }
         }
@@ -148,9 +235,27 @@ bool VerifyMLSAG(const CTransaction &tx, CValidationState &state)
                 &vpInCommits[0], &vpOutCommits[0], nullptr)))
             return state.DoS(100, error("%s: prepare-mlsag-failed %d", __func__, rv), REJECT_INVALID, "prepare-mlsag-failed");
 
-        if (0 != (rv = secp256k1_verify_mlsag(secp256k1_ctx_blind, txhash.begin(), nCols, nRows, &vM[0], &vKeyImages[0],
-                &vDL[0], &vDL[32])))
+        // vM now holds the ring and commitment sums the signature is checked against
+        uint256 entry;
+        uint8_t nDims[2] = {(uint8_t)nCols, (uint8_t)nRows};
+        CSHA256 hasher = ProofCacheHasher('M');
+        hasher.Write(txhash.begin(), 32).Write(nDims, 2).Write(&vM[0], vM.size())
+            .Write(&vKeyImages[0], vKeyImages.size()).Write(&vDL[0], vDL.size());
+        if (fHavePoints)
+            hasher.Write(&vPKH[0], vPKH.size());
+        hasher.Finalize(entry.begin());
+        if (ProofCacheContains(entry))
+            continue;
+
+        if (fHavePoints)
+            rv = secp256k1_verify_mlsag_points(secp256k1_ctx_blind, txhash.begin(), nCols, nRows, &vM[0], &vPKH[0],
+                &vKeyImages[0], &vDL[0], &vDL[32]);
+        else
+            rv = secp256k1_verify_mlsag(secp256k1_ctx_blind, txhash.begin(), nCols, nRows, &vM[0], &vKeyImages[0],
+                &vDL[0], &vDL[32]);
+        if (0 != rv)
             return state.DoS(100, error("%s: verify-mlsag-failed %d", __func__, rv), REJECT_INVALID, "verify-mlsag-failed");
+        ProofCacheAdd(entry);
     }
 
     // Verify commitment sums match
@@ -258,6 +363,36 @@ bool AllAnonOutputsUnknown(const CTransaction &tx, CValidationState &state)
 }
 
 
+int64_t GetLastRCTOutputAtHeight(const CChain &chain, int nHeight)
+{
+    const CBlockIndex *pindex = chain[std::min(nHeight, chain.Height())];
+    return pindex ? pindex->nAnonOutputs : 0;
+}
+
+int64_t GetLastSpendableRCTOutput(const CChain &chain, int nMinDepth)
+{
+    // An output at height h has depth tip - h, nAnonOutputs is cumulative
+    return GetLastRCTOutputAtHeight(chain, chain.Height() - nMinDepth);
+}
+
+int64_t SampleRCTDecoy(int64_t nLastIndex, int64_t nGroup1, int64_t nGroup2)
+{
+    if (nLastIndex < 1) {
+        return 0;
+    }
+
+    int64_t nMinIndex = 1;
+    if (GetRandInt(100) < 50) { // 50% chance of selecting from the last nGroup1
+        nMinIndex = std::max((int64_t)1, nLastIndex - nGroup1);
+    } else
+    if (GetRandInt(100) < 70) { // further 70% chance of selecting from the last nGroup2
+        nMinIndex = std::max((int64_t)1, nLastIndex - nGroup2);
+    }
+
+    return nMinIndex + GetRand((nLastIndex - nMinIndex) + 1);
+}
+
+
 bool RollBackRCTIndex(int64_t nLastValidRCTOutput, int64_t nExpectErase, std::set<CCmpPubKey> &setKi)
 {
     LogPrintf("%s: Last valid %d, expect to erase %d, num ki %d\n", __func__, nLastValidRCTOutput, nExpectErase, setKi.size());
@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <primitives/transaction.h>
 
+class CChain;
 class CTxMemPool;
 class CValidationState;
 
@@ -15,13 +16,40 @@ const size_t MAX_ANON_INPUTS = 32; // To raise see MLSAG_MAX_ROWS also
 const size_t ANON_FEE_MULTIPLIER = 2;
 
 
-bool VerifyMLSAG(const CTransaction &tx, CValidationState &state);
+/**
+ * Check the MLSAGs of the anon inputs of tx. Without fCheckKeyImages only the
+ * signatures are checked, key images are not looked up in the mempool or the
+ * chain, which needs cs_main.
+ */
+bool VerifyMLSAG(const CTransaction &tx, CValidationState &state, bool fCheckKeyImages = true);
+
+/**
+ * Fill the in-memory filter of spent key images from the block tree DB,
+ * sized for at least nExpected key images.
+ */
+bool LoadKeyImageFilter(int64_t nExpected);
+/** Add key images just written to the block tree DB to the filter */
+void AddKeyImagesToFilter(const std::vector<std::pair<CCmpPubKey, uint256> > &vKeyImages);
+/** Look up a key image spent in the chain, the DB is only read on a filter match */
+bool GetSpentKeyImage(const CCmpPubKey &ki, uint256 &txhash);
 
 bool AddKeyImagesToMempool(const CTransaction &tx, CTxMemPool &pool);
 bool RemoveKeyImagesFromMempool(const uint256 &hash, const CTxIn &txin, CTxMemPool &pool);
 
 bool AllAnonOutputsUnknown(const CTransaction &tx, CValidationState &state);
 
+/** Last RCT output index created in a block at or below nHeight of chain, 0 if there is none */
+int64_t GetLastRCTOutputAtHeight(const CChain &chain, int nHeight);
+
+/** Last RCT output index buried at least nMinDepth blocks below the tip of chain */
+int64_t GetLastSpendableRCTOutput(const CChain &chain, int nMinDepth);
+
+/**
+ * Draw a decoy index from [1, nLastIndex] without reading the RCT index.
+ * 50% of draws come from the last nGroup1 outputs, 70% of the rest from the last nGroup2.
+ */
+int64_t SampleRCTDecoy(int64_t nLastIndex, int64_t nGroup1, int64_t nGroup2);
+
 bool RollBackRCTIndex(int64_t nLastValidRCTOutput, int64_t nExpectErase, std::set<CCmpPubKey> &setKi);
 
 bool RewindToCheckpoint(int nCheckPointHeight, int &nBlocks, std::string &sError);
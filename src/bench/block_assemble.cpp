@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <blind.h>
 #include <chainparams.h>
 #include <coins.h>
 #include <consensus/merkle.h>
@@ -67,6 +68,7 @@ static void AssembleBlock(benchmark::State& state)
     SelectParams(CBaseChainParams::REGTEST);
 
     InitScriptExecutionCache();
+    InitProofCache();
 
     boost::thread_group thread_group;
     CScheduler scheduler;
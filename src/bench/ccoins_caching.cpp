@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <coins.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <wallet/crypter.h>
 
 #include <vector>
@@ -85,3 +86,63 @@ static void CCoinsCaching(benchmark::State& state)
 }
 
 BENCHMARK(CCoinsCaching, 170 * 1000);
+
+//! The cache map as it was before entries came from a pool: one malloc per node.
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMapNodeAlloc;
+
+static const size_t CACHE_CHURN_COINS = 20000;
+
+static Coin MakeChurnCoin(FastRandomContext& rand, uint32_t n)
+{
+    Coin coin;
+    coin.out.nValue = n + 1;
+    coin.out.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << rand.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG;
+    if (n % 8 == 0) {
+        coin.nType = OUTPUT_CT;
+        memset(coin.commitment.Set().data, 0x09, 33);
+    }
+    return coin;
+}
+
+// Fill, look up and spend a block's worth of coins, the access pattern of
+// connecting blocks during IBD.
+template <typename Map>
+static void CoinsMapChurn(Map& map, FastRandomContext& rand, std::vector<COutPoint>& vOutpoints)
+{
+    vOutpoints.clear();
+    for (uint32_t i = 0; i < CACHE_CHURN_COINS; i++) {
+        COutPoint outpoint(rand.rand256(), i);
+        vOutpoints.push_back(outpoint);
+        map.emplace(std::piecewise_construct, std::forward_as_tuple(outpoint), std::forward_as_tuple(MakeChurnCoin(rand, i)));
+    }
+    for (const COutPoint& outpoint : vOutpoints) {
+        assert(map.find(outpoint) != map.end());
+    }
+    for (const COutPoint& outpoint : vOutpoints) {
+        map.erase(outpoint);
+    }
+}
+
+static void CCoinsMapNodeAllocChurn(benchmark::State& state)
+{
+    FastRandomContext rand(true);
+    std::vector<COutPoint> vOutpoints;
+    CCoinsMapNodeAlloc map;
+    while (state.KeepRunning()) {
+        CoinsMapChurn(map, rand, vOutpoints);
+    }
+}
+
+static void CCoinsMapPoolChurn(benchmark::State& state)
+{
+    FastRandomContext rand(true);
+    std::vector<COutPoint> vOutpoints;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map(0, SaltedOutpointHasher(), CCoinsMap::key_equal(), &resource);
+    while (state.KeepRunning()) {
+        CoinsMapChurn(map, rand, vOutpoints);
+    }
+}
+
+BENCHMARK(CCoinsMapNodeAllocChurn, 20);
+BENCHMARK(CCoinsMapPoolChurn, 20);
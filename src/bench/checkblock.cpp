@@ -8,6 +8,7 @@
 #include <validation.h>
 #include <streams.h>
 #include <consensus/validation.h>
+#include <tinyformat.h>
 
 namespace block_bench {
 #include <bench/data/blockbench.raw.h>
@@ -52,5 +53,78 @@ static void DeserializeAndCheckBlockTest(benchmark::State& state)
     }
 }
 
+// A block of confidential transactions, each with two CT outputs carrying
+// full size range proofs and an input witness.
+static std::vector<unsigned char> MakeCTBlock()
+{
+    CBlock block;
+    for (int i = 0; i < 100; i++) {
+        CMutableTransaction mtx;
+        mtx.nVersion = GLOBE_TXN_VERSION;
+        mtx.SetType(TXN_STANDARD);
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint(uint256S(strprintf("%064x", i + 1)), 0);
+        mtx.vin[0].scriptWitness.stack.push_back(std::vector<unsigned char>(72, 0x30));
+        mtx.vin[0].scriptWitness.stack.push_back(std::vector<unsigned char>(33, 0x02));
+
+        auto out_fee = MAKE_OUTPUT<CTxOutData>();
+        out_fee->vData = {DO_FEE, 0x80, 0x01};
+        mtx.vpout.push_back(out_fee);
+        for (int k = 0; k < 2; k++) {
+            auto out = MAKE_OUTPUT<CTxOutCT>();
+            memset(out->commitment.data, 0x08 + k, 33);
+            out->vData.assign(33, 0x02);
+            out->scriptPubKey << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, i) << OP_EQUALVERIFY << OP_CHECKSIG;
+            out->vRangeproof.resize(5134);
+            for (size_t j = 0; j < out->vRangeproof.size(); j++) {
+                out->vRangeproof[j] = (j * 31 + i + k) & 0xff;
+            }
+            mtx.vpout.push_back(out);
+        }
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << block;
+    return std::vector<unsigned char>(stream.begin(), stream.end());
+}
+
+static void DeserializeCTBlockTest(benchmark::State& state)
+{
+    const std::vector<unsigned char> data = MakeCTBlock();
+    CDataStream stream(data, SER_NETWORK, PROTOCOL_VERSION);
+    char a = '\0';
+    stream.write(&a, 1); // Prevent compaction
+
+    while (state.KeepRunning()) {
+        CBlock block;
+        stream >> block;
+        assert(stream.Rewind(data.size()));
+    }
+}
+
+// The same block read through CMutableTransaction, which hashes every
+// transaction by serializing it again.
+static void DeserializeCTBlockRehashTest(benchmark::State& state)
+{
+    const std::vector<unsigned char> data = MakeCTBlock();
+    CDataStream stream(data, SER_NETWORK, PROTOCOL_VERSION);
+    char a = '\0';
+    stream.write(&a, 1); // Prevent compaction
+
+    while (state.KeepRunning()) {
+        CBlockHeader header;
+        std::vector<CMutableTransaction> vtx;
+        stream >> header >> vtx;
+        std::vector<CTransactionRef> vtx_ref;
+        for (auto& mtx : vtx) {
+            vtx_ref.push_back(MakeTransactionRef(std::move(mtx)));
+        }
+        assert(stream.Rewind(data.size()));
+    }
+}
+
 BENCHMARK(DeserializeBlockTest, 130);
 BENCHMARK(DeserializeAndCheckBlockTest, 160);
+BENCHMARK(DeserializeCTBlockTest, 50);
+BENCHMARK(DeserializeCTBlockRehashTest, 50);
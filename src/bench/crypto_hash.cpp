@@ -60,6 +60,44 @@ static void SHA256D64_1024(benchmark::State& state)
     }
 }
 
+/* 1000 messages of typical transaction sizes, hashed one by one or all at once */
+static void MakeMessages(std::vector<uint8_t>& in, std::vector<const uint8_t*>& ptrs, std::vector<size_t>& lens)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+        lens.push_back(200 + (i * 37) % 400);
+        total += lens.back();
+    }
+    in.assign(total, 0);
+    for (size_t i = 0, pos = 0; i < 1000; pos += lens[i++]) {
+        ptrs.push_back(in.data() + pos);
+    }
+}
+
+static void SHA256D_1000_Serial(benchmark::State& state)
+{
+    std::vector<uint8_t> in, out(32 * 1000);
+    std::vector<const uint8_t*> ptrs;
+    std::vector<size_t> lens;
+    MakeMessages(in, ptrs, lens);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < 1000; ++i) {
+            CHash256().Write(ptrs[i], lens[i]).Finalize(out.data() + 32 * i);
+        }
+    }
+}
+
+static void SHA256D_1000_Multi(benchmark::State& state)
+{
+    std::vector<uint8_t> in, out(32 * 1000);
+    std::vector<const uint8_t*> ptrs;
+    std::vector<size_t> lens;
+    MakeMessages(in, ptrs, lens);
+    while (state.KeepRunning()) {
+        SHA256DMulti(out.data(), ptrs.data(), lens.data(), 1000);
+    }
+}
+
 static void SHA512(benchmark::State& state)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -103,5 +141,7 @@ BENCHMARK(SHA512, 330);
 BENCHMARK(SHA256_32b, 4700 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(SHA256D_1000_Serial, 250);
+BENCHMARK(SHA256D_1000_Multi, 250);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
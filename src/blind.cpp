@@ -8,12 +8,102 @@
 #include <assert.h>
 #include <secp256k1_rangeproof.h>
 
+#include <cuckoocache.h>
+#include <script/sigcache.h>
 #include <support/allocators/secure.h>
 #include <random.h>
+#include <uint256.h>
 #include <util.h>
 
+#include <boost/thread.hpp>
+
 secp256k1_context *secp256k1_ctx_blind = nullptr;
 
+namespace {
+/** Verified range proofs and MLSAGs, see InitProofCache */
+class CProofCache
+{
+private:
+    //! Entries are SHA256(nonce || tag || verification inputs)
+    uint256 nonce;
+    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    CSHA256 Hasher(char tag) const
+    {
+        CSHA256 hasher;
+        hasher.Write(nonce.begin(), 32).Write((const unsigned char*)&tag, 1);
+        return hasher;
+    }
+
+    bool Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.contains(entry, false);
+    }
+
+    void Set(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+};
+
+static CProofCache proofCache;
+} // namespace
+
+void InitProofCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxproofcachesize", DEFAULT_MAX_PROOF_CACHE_SIZE)), MAX_MAX_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = proofCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for proof cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+CSHA256 ProofCacheHasher(char tag)
+{
+    return proofCache.Hasher(tag);
+}
+
+bool ProofCacheContains(const uint256 &entry)
+{
+    return proofCache.Get(entry);
+}
+
+void ProofCacheAdd(const uint256 &entry)
+{
+    proofCache.Set(entry);
+}
+
+bool VerifyRangeproof(const secp256k1_pedersen_commitment &commitment, const std::vector<uint8_t> &vRangeproof)
+{
+    uint256 entry;
+    ProofCacheHasher('R').Write(commitment.data, 33).Write(vRangeproof.data(), vRangeproof.size()).Finalize(entry.begin());
+    if (proofCache.Get(entry)) {
+        return true;
+    }
+
+    uint64_t min_value, max_value;
+    if (1 != secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &commitment, vRangeproof.data(),
+            vRangeproof.size(), nullptr, 0, secp256k1_generator_h)) {
+        return false;
+    }
+    proofCache.Set(entry);
+    return true;
+}
+
 static int CountLeadingZeros(uint64_t nValueIn)
 {
     int nZeros = 0;
@@ -131,6 +221,9 @@ void ECC_Start_Blinding()
         assert(ret);
     }
 
+    // Precompute multiples of H, every blinded output commits to a value times H.
+    secp256k1_pedersen_context_initialize(ctx);
+
     secp256k1_ctx_blind = ctx;
 };
 
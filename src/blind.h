@@ -6,10 +6,19 @@
 #define GLOBE_BLIND_H
 
 #include <secp256k1.h>
+#include <secp256k1_rangeproof.h>
 #include <inttypes.h>
 #include <vector>
 
 #include <amount.h>
+#include <crypto/sha256.h>
+
+class uint256;
+
+/** Default for -maxproofcachesize, in MiB */
+static const unsigned int DEFAULT_MAX_PROOF_CACHE_SIZE = 8;
+/** Maximum proof cache size allowed */
+static const int64_t MAX_MAX_PROOF_CACHE_SIZE = 16384;
 
 extern secp256k1_context *secp256k1_ctx_blind;
 
@@ -17,6 +26,21 @@ int SelectRangeProofParameters(uint64_t nValueIn, uint64_t &minValue, int &expon
 
 int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &rmantissa, CAmount &min_value, CAmount &max_value);
 
+/**
+ * Range proofs and MLSAGs that verified are kept in a cache, so a transaction
+ * checked on mempool acceptance or pre-validation is not verified again on
+ * acceptance or in a block. An entry is a nonced hash of all the data the
+ * verification reads, so a hit is as good as verifying.
+ */
+void InitProofCache();
+/** A hasher for a new entry, already holding the nonce and tag. Write the verification inputs to it. */
+CSHA256 ProofCacheHasher(char tag);
+bool ProofCacheContains(const uint256 &entry);
+void ProofCacheAdd(const uint256 &entry);
+
+/** Verify a range proof of a commitment to H, through the proof cache */
+bool VerifyRangeproof(const secp256k1_pedersen_commitment &commitment, const std::vector<uint8_t> &vRangeproof);
+
 void ECC_Start_Blinding();
 void ECC_Stop_Blinding();
 
@@ -6,6 +6,7 @@
 
 #include <primitives/transaction.h>
 #include <hash.h>
+#include <memusage.h>
 #include <script/script.h>
 #include <script/standard.h>
 #include <random.h>
@@ -319,3 +320,52 @@ void CRollingBloomFilter::reset()
         *it = 0;
     }
 }
+
+/* Odd multipliers spreading one 32 bit hash over a bit index for each word of a block */
+static const uint32_t BLOCKED_BLOOM_SALT[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+CBlockedBloomFilter::CBlockedBloomFilter(const unsigned int nElements) :
+    k0(GetRand(std::numeric_limits<uint64_t>::max())),
+    k1(GetRand(std::numeric_limits<uint64_t>::max())),
+    nMaxElements(std::max(nElements, 1u)),
+    nInserted(0)
+{
+    /* 16 bits per element, 512 bits per block. */
+    data.resize(((nMaxElements + 31) / 32) * BLOCK_WORDS);
+}
+
+uint64_t CBlockedBloomFilter::Hash(const unsigned char* pch, size_t len) const
+{
+    return CSipHasher(k0, k1).Write(pch, len).Finalize();
+}
+
+void CBlockedBloomFilter::insert(const unsigned char* pch, size_t len)
+{
+    uint64_t h = Hash(pch, len);
+    /* The upper half selects the block, the lower half the bit in each word. */
+    uint64_t *block = &data[FastMod(h >> 32, data.size() / BLOCK_WORDS) * BLOCK_WORDS];
+    for (int i = 0; i < BLOCK_WORDS; i++) {
+        block[i] |= ((uint64_t)1) << (((uint32_t)h * BLOCKED_BLOOM_SALT[i]) >> 26);
+    }
+    nInserted++;
+}
+
+bool CBlockedBloomFilter::contains(const unsigned char* pch, size_t len) const
+{
+    uint64_t h = Hash(pch, len);
+    const uint64_t *block = &data[FastMod(h >> 32, data.size() / BLOCK_WORDS) * BLOCK_WORDS];
+    for (int i = 0; i < BLOCK_WORDS; i++) {
+        if (!((block[i] >> (((uint32_t)h * BLOCKED_BLOOM_SALT[i]) >> 26)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t CBlockedBloomFilter::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(data);
+}
@@ -140,4 +140,45 @@ private:
     int nHashFuncs;
 };
 
+/**
+ * BlockedBloomFilter is an insert-only set with no false negatives, meant to
+ * sit in front of a large on-disk set so that most lookups of absent items
+ * skip the database.
+ *
+ * All bits of an item are in one block of 8 words, one bit per word, so a
+ * lookup reads 64 contiguous bytes. The filter uses 16 bits per expected
+ * element, for a false positive rate around 0.1% up to nElements items; it
+ * degrades gracefully past that, and IsFull() tells the owner to rebuild a
+ * larger one.
+ *
+ * Like CRollingBloomFilter it is keyed with a random salt on creation, don't
+ * create global objects before the randomizer is initialized.
+ */
+class CBlockedBloomFilter
+{
+public:
+    explicit CBlockedBloomFilter(const unsigned int nElements);
+
+    void insert(const unsigned char* pch, size_t len);
+    bool contains(const unsigned char* pch, size_t len) const;
+
+    //! Number of insert() calls, an item inserted twice counts twice
+    unsigned int size() const { return nInserted; }
+    //! Number of elements the filter was sized for
+    unsigned int MaxElements() const { return nMaxElements; }
+    bool IsFull() const { return nInserted >= nMaxElements; }
+
+    size_t DynamicMemoryUsage() const;
+
+private:
+    static const int BLOCK_WORDS = 8;
+
+    uint64_t Hash(const unsigned char* pch, size_t len) const;
+
+    const uint64_t k0, k1;
+    unsigned int nMaxElements;
+    unsigned int nInserted;
+    std::vector<uint64_t> data;
+};
+
 #endif // BITCOIN_BLOOM_H
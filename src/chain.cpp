@@ -5,6 +5,10 @@
 
 #include <chain.h>
 
+#include <memusage.h>
+
+CBlockSigStore g_block_sigs;
+
 /**
  * CChain implementation
  */
@@ -168,3 +172,101 @@ const CBlockIndex* LastCommonAncestor(const CBlockIndex* pa, const CBlockIndex*
     assert(pa == pb);
     return pa;
 }
+
+bool CBlockIndex::GetBlockSig(std::vector<unsigned char>& vchBlockSig) const
+{
+    vchBlockSig.clear();
+    if (!IsProofOfStake())
+        return true;
+    return g_block_sigs.Get(this, vchBlockSig);
+}
+
+void CBlockSigStore::Add(const CBlockIndex* pindex, const std::vector<unsigned char>& vchBlockSig)
+{
+    if (vchBlockSig.empty())
+        return;
+    LOCK(cs_sigs);
+    mapPending[pindex] = vchBlockSig;
+}
+
+void CBlockSigStore::Release(const CBlockIndex* pindex)
+{
+    LOCK(cs_sigs);
+    auto it = mapPending.find(pindex);
+    if (it == mapPending.end())
+        return;
+    AddRecent(pindex, std::move(it->second));
+    mapPending.erase(it);
+}
+
+void CBlockSigStore::AddRecent(const CBlockIndex* pindex, std::vector<unsigned char> vchBlockSig) const
+{
+    if (!mapRecent.emplace(pindex, std::move(vchBlockSig)).second)
+        return;
+    if (vRecent.size() < MAX_RECENT_BLOCK_SIGS) {
+        vRecent.push_back(pindex);
+        return;
+    }
+    mapRecent.erase(vRecent[nRecentNext]);
+    vRecent[nRecentNext] = pindex;
+    nRecentNext = (nRecentNext + 1) % MAX_RECENT_BLOCK_SIGS;
+}
+
+bool CBlockSigStore::Get(const CBlockIndex* pindex, std::vector<unsigned char>& vchBlockSig) const
+{
+    ReadFunc reader;
+    {
+        LOCK(cs_sigs);
+        auto it = mapPending.find(pindex);
+        if (it != mapPending.end()) {
+            vchBlockSig = it->second;
+            return true;
+        }
+        it = mapRecent.find(pindex);
+        if (it != mapRecent.end()) {
+            vchBlockSig = it->second;
+            return true;
+        }
+        reader = fnRead;
+    }
+    if (!reader || !reader(pindex, vchBlockSig))
+        return false;
+
+    LOCK(cs_sigs);
+    AddRecent(pindex, vchBlockSig);
+    return true;
+}
+
+void CBlockSigStore::Clear()
+{
+    LOCK(cs_sigs);
+    mapPending.clear();
+    mapRecent.clear();
+    vRecent.clear();
+    nRecentNext = 0;
+}
+
+void CBlockSigStore::SetReader(ReadFunc reader)
+{
+    LOCK(cs_sigs);
+    fnRead = reader;
+}
+
+size_t CBlockSigStore::Size() const
+{
+    LOCK(cs_sigs);
+    return mapPending.size();
+}
+
+size_t CBlockSigStore::DynamicMemoryUsage() const
+{
+    LOCK(cs_sigs);
+    size_t nUsage = memusage::DynamicUsage(mapPending) + memusage::DynamicUsage(mapRecent) + memusage::DynamicUsage(vRecent);
+    for (const auto& entry : mapPending) {
+        nUsage += memusage::DynamicUsage(entry.second);
+    }
+    for (const auto& entry : mapRecent) {
+        nUsage += memusage::DynamicUsage(entry.second);
+    }
+    return nUsage;
+}
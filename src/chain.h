@@ -9,9 +9,12 @@
 #include <arith_uint256.h>
 #include <consensus/params.h>
 #include <primitives/block.h>
+#include <sync.h>
 #include <tinyformat.h>
 #include <uint256.h>
 
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -219,8 +222,7 @@ public:
     uint32_t nNonce;
     uint256 hashStateRoot; // qtum
     uint256 hashUTXORoot; // qtum
-    // block signature - proof-of-stake protect the block by signing the block using a stake holder private key
-    std::vector<unsigned char> vchBlockSig;
+    // The block signature is kept out of line, see CBlockSigStore
     uint256 nStakeModifier;
     // proof-of-stake specific fields
     COutPoint prevoutStake;
@@ -259,7 +261,6 @@ public:
         nNonce         = 0;
         hashStateRoot  = uint256(); // qtum
         hashUTXORoot   = uint256(); // qtum
-        vchBlockSig.clear();
         nStakeModifier = uint256();
         hashProof = uint256();
         prevoutStake.SetNull();
@@ -286,7 +287,6 @@ public:
         nStakeModifier = uint256();
         hashProof = uint256(); 
         prevoutStake   = block.prevoutStake; // qtum
-        vchBlockSig    = block.vchBlockSig; // qtum
     }
 
     CDiskBlockPos GetBlockPos() const {
@@ -307,9 +307,9 @@ public:
         return ret;
     }
 
-    CBlockHeader GetBlockHeader() const
+    //! Build the header, fails if the proof-of-stake block signature cannot be read.
+    bool GetBlockHeader(CBlockHeader& block) const
     {
-        CBlockHeader block;
         block.nVersion       = nVersion;
         if (pprev)
             block.hashPrevBlock = pprev->GetBlockHash();
@@ -319,11 +319,13 @@ public:
         block.nNonce         = nNonce;
         block.hashStateRoot  = hashStateRoot; // qtum
         block.hashUTXORoot   = hashUTXORoot; // qtum
-        block.vchBlockSig    = vchBlockSig;
         block.prevoutStake   = prevoutStake;
-        return block;
+        return GetBlockSig(block.vchBlockSig);
     }
 
+    //! Fetch the proof-of-stake block signature from CBlockSigStore, empty for proof-of-work blocks.
+    bool GetBlockSig(std::vector<unsigned char>& vchBlockSig) const;
+
     uint256 GetBlockHash() const
     {
         return *phashBlock;
@@ -416,6 +418,8 @@ class CDiskBlockIndex : public CBlockIndex
 {
 public:
     uint256 hashPrev;
+    // block signature - proof-of-stake protect the block by signing the block using a stake holder private key
+    std::vector<unsigned char> vchBlockSig;
 
     CDiskBlockIndex() {
         hashPrev = uint256();
@@ -423,6 +427,7 @@ public:
 
     explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex) {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
+        pindex->GetBlockSig(vchBlockSig);
     }
 
     ADD_SERIALIZE_METHODS;
@@ -457,10 +462,10 @@ public:
         READWRITE(prevoutStake);
         READWRITE(hashProof);
         READWRITE(vchBlockSig); // qtum
-    }
 
-    //Ring CT
-    READWRITE(nAnonOutputs);
+        //Ring CT
+        READWRITE(nAnonOutputs);
+    }
 
     uint256 GetBlockHash() const
     {
@@ -490,6 +495,50 @@ public:
     }
 };
 
+/** Number of written out or read back signatures CBlockSigStore keeps, a few getheaders replies */
+static const size_t MAX_RECENT_BLOCK_SIGS = 10000;
+
+/**
+ * Proof-of-stake block signatures, kept out of CBlockIndex as they are only
+ * needed to relay headers and to write the block index.
+ * Signatures of entries not yet written to the block tree db are held here
+ * until the next flush, all others are read back from the db on demand.
+ * The last MAX_RECENT_BLOCK_SIGS signatures released or read back are kept,
+ * so announcing new blocks and answering getheaders for the recent chain do
+ * not read the db under cs_main.
+ */
+class CBlockSigStore
+{
+public:
+    typedef std::function<bool(const CBlockIndex*, std::vector<unsigned char>&)> ReadFunc;
+
+    //! Hold the signature of a new entry until it has been written out.
+    void Add(const CBlockIndex* pindex, const std::vector<unsigned char>& vchBlockSig);
+    //! Move the signature to the recent ones once the entry is in the block tree db.
+    void Release(const CBlockIndex* pindex);
+    bool Get(const CBlockIndex* pindex, std::vector<unsigned char>& vchBlockSig) const;
+    void Clear();
+
+    //! Set how signatures that are not held in memory are read back.
+    void SetReader(ReadFunc reader);
+
+    size_t Size() const;
+    size_t DynamicMemoryUsage() const;
+
+private:
+    void AddRecent(const CBlockIndex* pindex, std::vector<unsigned char> vchBlockSig) const EXCLUSIVE_LOCKS_REQUIRED(cs_sigs);
+
+    mutable CCriticalSection cs_sigs;
+    std::unordered_map<const CBlockIndex*, std::vector<unsigned char> > mapPending GUARDED_BY(cs_sigs);
+    //! Recently released or read back signatures, vRecent is a ring of their entries with the oldest at nRecentNext
+    mutable std::unordered_map<const CBlockIndex*, std::vector<unsigned char> > mapRecent GUARDED_BY(cs_sigs);
+    mutable std::vector<const CBlockIndex*> vRecent GUARDED_BY(cs_sigs);
+    mutable size_t nRecentNext GUARDED_BY(cs_sigs) = 0;
+    ReadFunc fnRead GUARDED_BY(cs_sigs);
+};
+
+extern CBlockSigStore g_block_sigs;
+
 /** An in-memory indexed chain of blocks. */
 class CChain {
 private:
@@ -14,14 +14,57 @@
 #include <serialize.h>
 #include <uint256.h>
 #include <rctindex.h>
+#include <support/allocators/pool.h>
 
 #include <assert.h>
 #include <stdint.h>
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 extern bool fGlobeMode;
 
+/**
+ * Pedersen commitment of an OUTPUT_CT coin.
+ * Held out of line so that the far more common OUTPUT_STANDARD coins only
+ * pay for a pointer instead of 33 bytes in every cache entry.
+ */
+class CoinCommitment
+{
+private:
+    std::unique_ptr<secp256k1_pedersen_commitment> pcommitment;
+
+public:
+    CoinCommitment() {}
+    CoinCommitment(const CoinCommitment &other) { *this = other; }
+    CoinCommitment(CoinCommitment &&other) = default;
+
+    CoinCommitment &operator=(const CoinCommitment &other)
+    {
+        if (this != &other)
+            pcommitment.reset(other.pcommitment ? new secp256k1_pedersen_commitment(*other.pcommitment) : nullptr);
+        return *this;
+    }
+    CoinCommitment &operator=(CoinCommitment &&other) = default;
+
+    bool IsNull() const { return !pcommitment; }
+    void SetNull() { pcommitment.reset(); }
+
+    const secp256k1_pedersen_commitment &Get() const;
+    secp256k1_pedersen_commitment &Set()
+    {
+        if (!pcommitment)
+            pcommitment.reset(new secp256k1_pedersen_commitment());
+        return *pcommitment;
+    }
+
+    size_t DynamicMemoryUsage() const
+    {
+        return pcommitment ? memusage::MallocUsage(sizeof(secp256k1_pedersen_commitment)) : 0;
+    }
+};
+
 /**
  * A UTXO entry.
  *
@@ -44,7 +87,8 @@ public:
     uint32_t nHeight : 30;
 
     uint8_t nType = OUTPUT_STANDARD;
-    secp256k1_pedersen_commitment commitment;
+    //! only set for OUTPUT_CT
+    CoinCommitment commitment;
 
     //! construct a Coin from a CTxOut and height/coinbase information.
     Coin(CTxOut&& outIn, int nHeightIn, bool fCoinBaseIn, bool fCoinStakeIn) : out(std::move(outIn)), fCoinBase(fCoinBaseIn), fCoinStake(fCoinStakeIn), nHeight(nHeightIn) {}
@@ -62,7 +106,7 @@ public:
             && out.nValue != txo->GetValue())
             return false;
         if (nType == OUTPUT_CT
-            && memcmp(commitment.data, ((CTxOutCT*)txo)->commitment.data, 33) != 0)
+            && memcmp(commitment.Get().data, ((CTxOutCT*)txo)->commitment.data, 33) != 0)
             return false;
         return true;
     }
@@ -72,6 +116,7 @@ public:
         fCoinBase = false;
         fCoinStake = false;
         nHeight = 0;
+        commitment.SetNull();
     }
 
     //! empty constructor
@@ -93,7 +138,7 @@ public:
         if (!fGlobeMode) return;
         ::Serialize(s, nType);
         if (nType == OUTPUT_CT)
-            s.write((char*)&commitment.data[0], 33);
+            s.write((char*)&commitment.Get().data[0], 33);
     }
 
     template<typename Stream>
@@ -107,7 +152,9 @@ public:
         if (!fGlobeMode) return;
         ::Unserialize(s, nType);
         if (nType == OUTPUT_CT)
-            s.read((char*)&commitment.data[0], 33);
+            s.read((char*)&commitment.Set().data[0], 33);
+        else
+            commitment.SetNull();
     }
 
     bool IsSpent() const {
@@ -115,7 +162,7 @@ public:
     }
 
     size_t DynamicMemoryUsage() const {
-        return memusage::DynamicUsage(out.scriptPubKey);
+        return memusage::DynamicUsage(out.scriptPubKey) + commitment.DynamicMemoryUsage();
     }
 };
 
@@ -157,7 +204,15 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * Cache entries are allocated from a PoolResource owned by the cache: one
+ * node is the entry plus the hash table's next pointer and cached hash, the
+ * extra pointers leave room for other standard library layouts.
+ */
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+                           PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                                         sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void*) * 4>> CCoinsMap;
+typedef CCoinsMap::allocator_type::ResourceType CCoinsMapMemoryResource;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -245,6 +300,8 @@ public:
      */
     mutable uint256 hashBlock;
     mutable int nBlockHeight = 0;
+    /* Backs the nodes of cacheCoins, so must be declared before it. */
+    mutable CCoinsMapMemoryResource cacheCoinsMemoryResource;
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -353,6 +410,12 @@ public:
 
 private:
     CCoinsMap::iterator FetchCoin(const COutPoint &outpoint) const;
+
+    /**
+     * Replace the emptied cache map and its pool with fresh ones, returning
+     * the pool's chunks to the system.
+     */
+    void ReallocateCache();
 };
 
 //! Utility function to add all of a transaction's outputs to a cache.
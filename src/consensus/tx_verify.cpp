@@ -187,7 +187,7 @@ bool CheckStandardOutput(CValidationState &state, const Consensus::Params& conse
     return !CheckValue(state, p->nValue, nValueOut);
 }
 
-bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p)
+bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p, bool fCheckRangeproof)
 {
     if (p->vData.size() < 33 || p->vData.size() > 33 + 5)
         return state.DoS(100, false, REJECT_INVALID, "bad-ctout-ephem-size");
@@ -197,20 +197,16 @@ bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p)
         return state.DoS(100, false, REJECT_INVALID, "bad-ctout-rangeproof-size");
 
 
-    if (/*todo: fBusyImporting && */ fSkipRangeproof)
+    if (!fCheckRangeproof || /*todo: fBusyImporting && */ fSkipRangeproof)
         return true;
 
-    uint64_t min_value, max_value;
-    int rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &p->commitment, p->vRangeproof.data(),
-            p->vRangeproof.size(), nullptr, 0, secp256k1_generator_h);
-
-    if (rv != 1)
+    if (!VerifyRangeproof(p->commitment, p->vRangeproof))
         return state.DoS(100, false, REJECT_INVALID, "bad-ctout-rangeproof-verify");
 
     return true;
 }
 
-bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p)
+bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p, bool fCheckRangeproof)
 {
     if (Params().NetworkIDString() == "main")
         return state.DoS(100, false, REJECT_INVALID, "AnonOutput in mainnet");
@@ -222,14 +218,10 @@ bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p)
     if (p->vRangeproof.size() > nRangeProofLen)
         return state.DoS(100, false, REJECT_INVALID, "bad-rctout-rangeproof-size");
 
-    if (/* todo: fBusyImporting && */ fSkipRangeproof)
+    if (!fCheckRangeproof || /* todo: fBusyImporting && */ fSkipRangeproof)
         return true;
 
-    uint64_t min_value, max_value;
-    int rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value, &p->commitment, p->vRangeproof.data(),
-            p->vRangeproof.size(), nullptr, 0, secp256k1_generator_h);
-
-    if (rv != 1)
+    if (!VerifyRangeproof(p->commitment, p->vRangeproof))
         return state.DoS(100, false, REJECT_INVALID, "bad-rctout-rangeproof-verify");
 
     return true;
@@ -247,7 +239,7 @@ bool CheckDataOutput(CValidationState &state, const CTxOutData *p)
     return true;
 }
 
-bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fCheckDuplicateInputs)
+bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fCheckDuplicateInputs, bool fCheckRangeproofs)
 {
     // Basic checks that don't depend on any context
     if (tx.vin.empty())
@@ -277,11 +269,11 @@ bool CheckTransaction(const CTransaction& tx, CValidationState &state, bool fChe
                     nStandardOutputs++;
                     break;
                 case OUTPUT_CT:
-                    if (!CheckBlindOutput(state, (CTxOutCT*) txout.get()))
+                    if (!CheckBlindOutput(state, (CTxOutCT*) txout.get(), fCheckRangeproofs))
                         return false;
                     break;
                 case OUTPUT_RINGCT:
-                    if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get()))
+                    if (!CheckAnonOutput(state, (CTxOutRingCT*) txout.get(), fCheckRangeproofs))
                         return false;
                     break;
                 case OUTPUT_DATA:
@@ -396,7 +388,7 @@ bool Consensus::CheckTxInputs(const CTransaction& tx, CValidationState& state, c
 
                 nStandard++;
             } else if (coin.nType == OUTPUT_CT) {
-                vpCommitsIn.push_back(&coin.commitment);
+                vpCommitsIn.push_back(&coin.commitment.Get());
                 nCt++;
             } else {
                 return state.DoS(100, false, REJECT_INVALID, "bad-txns-input-type");
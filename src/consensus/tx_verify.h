@@ -13,12 +13,17 @@
 class CBlockIndex;
 class CCoinsViewCache;
 class CTransaction;
+class CTxOutCT;
+class CTxOutRingCT;
 class CValidationState;
 
 /** Transaction validation functions */
 
-/** Context-independent validity checks */
-bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fCheckDuplicateInputs=true);
+/** Context-independent validity checks, without fCheckRangeproofs only the cheap structural ones */
+bool CheckTransaction(const CTransaction& tx, CValidationState& state, bool fCheckDuplicateInputs=true, bool fCheckRangeproofs=true);
+/** Checks of a single blinded or anon output done by CheckTransaction, including its range proof */
+bool CheckBlindOutput(CValidationState &state, const CTxOutCT *p, bool fCheckRangeproof=true);
+bool CheckAnonOutput(CValidationState &state, const CTxOutRingCT *p, bool fCheckRangeproof=true);
 
 namespace Consensus {
 /**
@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 #include <atomic>
 
 #if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
@@ -22,11 +23,13 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
+void TransformMulti_4way(uint32_t* const* s, const unsigned char* const* chunk);
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
+void TransformMulti_8way(uint32_t* const* s, const unsigned char* const* chunk);
 }
 
 namespace sha256d64_shani
@@ -416,6 +419,7 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+typedef void (*TransformMultiType)(uint32_t* const*, const unsigned char* const*);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -461,6 +465,8 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -544,6 +550,25 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformMulti_4way and TransformMulti_8way, if available. Lane i
+    // continues from the state after i blocks and processes block i.
+    for (TransformMultiType tr : {TransformMulti_4way, TransformMulti_8way}) {
+        if (!tr) continue;
+        uint32_t states[8][8];
+        uint32_t* s[8];
+        const unsigned char* chunk[8];
+        for (size_t i = 0; i < 8; ++i) {
+            std::copy(result[i], result[i] + 8, states[i]);
+            s[i] = states[i];
+            chunk[i] = data + 1 + 64 * i;
+        }
+        tr(s, chunk);
+        if (tr == TransformMulti_4way) tr(s + 4, chunk + 4);
+        for (size_t i = 0; i < 8; ++i) {
+            if (!std::equal(states[i], states[i] + 8, result[i + 1])) return false;
+        }
+    }
+
     return true;
 }
 
@@ -622,6 +647,7 @@ std::string SHA256AutoDetect()
 #endif
 #if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256d64_sse41::TransformMulti_4way;
         ret += ",sse41(4way)";
 #endif
     }
@@ -629,6 +655,7 @@ std::string SHA256AutoDetect()
 #if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256d64_avx2::TransformMulti_8way;
         ret += ",avx2(8way)";
     }
 #endif
@@ -695,6 +722,164 @@ CSHA256& CSHA256::Reset()
     return *this;
 }
 
+namespace
+{
+/** The state of one lane of SHA256Multi: a message being hashed. */
+struct MultiLane
+{
+    uint32_t s[8];
+    const unsigned char* data; //!< Next full block of the message
+    size_t blocks;             //!< Full blocks of the message left
+    unsigned char tail[128];   //!< The final partial block plus padding
+    size_t tail_blocks;        //!< Number of blocks in tail (1 or 2)
+    size_t tail_pos;           //!< Tail blocks processed so far
+    unsigned char* out;
+};
+
+void WriteState(unsigned char* out, const uint32_t* s)
+{
+    WriteBE32(out + 0, s[0]);
+    WriteBE32(out + 4, s[1]);
+    WriteBE32(out + 8, s[2]);
+    WriteBE32(out + 12, s[3]);
+    WriteBE32(out + 16, s[4]);
+    WriteBE32(out + 20, s[5]);
+    WriteBE32(out + 24, s[6]);
+    WriteBE32(out + 28, s[7]);
+}
+
+void StartLane(MultiLane& lane, unsigned char* out, const unsigned char* in, size_t len)
+{
+    sha256::Initialize(lane.s);
+    lane.data = in;
+    lane.blocks = len / 64;
+    size_t rem = len % 64;
+    lane.tail_blocks = rem < 56 ? 1 : 2;
+    lane.tail_pos = 0;
+    if (rem) memcpy(lane.tail, in + len - rem, rem);
+    lane.tail[rem] = 0x80;
+    memset(lane.tail + rem + 1, 0, 64 * lane.tail_blocks - rem - 9);
+    WriteBE64(lane.tail + 64 * lane.tail_blocks - 8, (uint64_t)len << 3);
+    lane.out = out;
+}
+
+const unsigned char* NextBlock(MultiLane& lane)
+{
+    if (lane.blocks) {
+        const unsigned char* ret = lane.data;
+        lane.data += 64;
+        --lane.blocks;
+        return ret;
+    }
+    return lane.tail + 64 * lane.tail_pos++;
+}
+
+bool LaneDone(const MultiLane& lane)
+{
+    return lane.blocks == 0 && lane.tail_pos == lane.tail_blocks;
+}
+
+/** Compute the double-SHA256 of count messages, LANES at a time with tr.
+ *  A lane picks up the next message as soon as its current one is done, so
+ *  messages of different lengths keep all lanes busy until the last few.
+ */
+template<size_t LANES>
+void SHA256DMultiLanes(TransformMultiType tr, unsigned char* out, const unsigned char* const* in, const size_t* lens, size_t count)
+{
+    static const unsigned char idle_block[64] = {0};
+    static const unsigned char padding[32] = {
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0
+    };
+    MultiLane lanes[LANES];
+    bool active[LANES] = {};
+    uint32_t idle_state[8] = {}; // Scratch state of idle lanes, the result is discarded
+    uint32_t* s[LANES];
+    const unsigned char* chunk[LANES];
+    size_t next = 0, num_active = 0;
+
+    // First hash, written to out.
+    while (true) {
+        for (size_t i = 0; i < LANES && next < count; ++i) {
+            if (!active[i]) {
+                StartLane(lanes[i], out + 32 * next, in[next], lens[next]);
+                active[i] = true;
+                ++num_active;
+                ++next;
+            }
+        }
+        if (num_active == 0) break;
+        if (num_active == 1 && next == count) {
+            // Only one message is left; finish it without the idle lanes.
+            for (size_t i = 0; i < LANES; ++i) {
+                if (!active[i]) continue;
+                MultiLane& lane = lanes[i];
+                Transform(lane.s, lane.data, lane.blocks);
+                Transform(lane.s, lane.tail + 64 * lane.tail_pos, lane.tail_blocks - lane.tail_pos);
+                WriteState(lane.out, lane.s);
+            }
+            break;
+        }
+        for (size_t i = 0; i < LANES; ++i) {
+            if (active[i]) {
+                s[i] = lanes[i].s;
+                chunk[i] = NextBlock(lanes[i]);
+            } else {
+                s[i] = idle_state;
+                chunk[i] = idle_block;
+            }
+        }
+        tr(s, chunk);
+        for (size_t i = 0; i < LANES; ++i) {
+            if (active[i] && LaneDone(lanes[i])) {
+                WriteState(lanes[i].out, lanes[i].s);
+                active[i] = false;
+                --num_active;
+            }
+        }
+    }
+
+    // Second hash: one block per message, in place.
+    for (size_t done = 0; done < count; done += LANES) {
+        const size_t n = std::min(LANES, count - done);
+        for (size_t i = 0; i < LANES; ++i) {
+            if (i < n) {
+                MultiLane& lane = lanes[i];
+                sha256::Initialize(lane.s);
+                memcpy(lane.tail, out + 32 * (done + i), 32);
+                memcpy(lane.tail + 32, padding, 32);
+                s[i] = lane.s;
+                chunk[i] = lane.tail;
+            } else {
+                s[i] = idle_state;
+                chunk[i] = idle_block;
+            }
+        }
+        tr(s, chunk);
+        for (size_t i = 0; i < n; ++i) {
+            WriteState(out + 32 * (done + i), lanes[i].s);
+        }
+    }
+}
+} // namespace
+
+void SHA256DMulti(unsigned char* out, const unsigned char* const* in, const size_t* lens, size_t count)
+{
+    if (TransformMulti_8way && count >= 8) {
+        SHA256DMultiLanes<8>(TransformMulti_8way, out, in, lens, count);
+        return;
+    }
+    if (TransformMulti_4way && count >= 2) {
+        SHA256DMultiLanes<4>(TransformMulti_4way, out, in, lens, count);
+        return;
+    }
+    unsigned char tmp[CSHA256::OUTPUT_SIZE];
+    for (size_t i = 0; i < count; ++i) {
+        CSHA256().Write(in[i], lens[i]).Finalize(tmp);
+        CSHA256().Write(tmp, sizeof(tmp)).Finalize(out + 32 * i);
+    }
+}
+
 void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
 {
     if (TransformD64_8way) {
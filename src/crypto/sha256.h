@@ -38,4 +38,12 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute multiple double-SHA256's of messages of arbitrary length.
+ *  output:  pointer to a count*32 byte output buffer, not overlapping any input
+ *  inputs:  pointers to the count input messages
+ *  lens:    the length in bytes of each input message
+ *  count:   the number of hashes to compute.
+ */
+void SHA256DMulti(unsigned char* output, const unsigned char* const* inputs, const size_t* lens, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
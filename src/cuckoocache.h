@@ -475,6 +475,22 @@ public:
             }
         return false;
     }
+
+    /** for_each calls fn on every element which has not been erased, e.g.
+     * to save the cache to disk. Erased elements are skipped even if they
+     * have not been garbage collected yet, and epochs are not reported.
+     *
+     * for_each is not safe to call concurrently with insert.
+     *
+     * @param fn a callable taking a const Element&
+     */
+    template <typename Fn>
+    void for_each(Fn fn) const
+    {
+        for (uint32_t i = 0; i < size; ++i)
+            if (!collection_flags.bit_is_set(i))
+                fn(table[i]);
+    }
 };
 } // namespace CuckooCache
 
@@ -1,3 +1,4 @@
+#include <map>
 #include <sstream>
 #include <util.h>
 #include <validation.h>
@@ -141,6 +142,46 @@ std::unordered_map<dev::Address, Vin> QtumState::vins() const // temp
     return ret;
 }
 
+void QtumState::forEachAccount(h256 const& _begin, std::function<bool(h256 const&, Address const&)> const& _f) const
+{
+    // Accounts touched since the last commit, in the order the trie uses
+    std::map<h256, Address> cached;
+    for (auto const& i : m_cache) {
+        h256 hashed = sha3(i.first);
+        if (i.second.isAlive() && hashed >= _begin)
+            cached.emplace(hashed, i.first);
+    }
+    auto itCached = cached.begin();
+
+#if ETH_FATDB
+    for (auto it = m_state.hashedLowerBound(_begin); it != m_state.hashedEnd(); ++it) {
+        h256 hashed((*it).first);
+        for (; itCached != cached.end() && itCached->first < hashed; ++itCached) {
+            if (!_f(itCached->first, itCached->second))
+                return;
+        }
+        Address address(it.key());
+        if (itCached != cached.end() && itCached->first == hashed) {
+            ++itCached;
+        } else {
+            // Killed since the last commit
+            auto c = m_cache.find(address);
+            if (c != m_cache.end() && !c->second.isAlive())
+                continue;
+        }
+        if (!_f(hashed, address))
+            return;
+    }
+#else
+    BOOST_THROW_EXCEPTION(InterfaceNotSupported() << errinfo_interface("QtumState::forEachAccount()"));
+#endif
+
+    for (; itCached != cached.end(); ++itCached) {
+        if (!_f(itCached->first, itCached->second))
+            return;
+    }
+}
+
 void QtumState::transferBalance(dev::Address const& _from, dev::Address const& _to, dev::u256 const& _value) {
     subBalance(_from, _value);
     addBalance(_to, _value);
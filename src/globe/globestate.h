@@ -74,6 +74,12 @@ public:
 
     std::unordered_map<dev::Address, Vin> vins() const; // temp
 
+    /// Visit live accounts in state trie order (by hashed address), starting
+    /// at the first hashed address >= _begin, until _f returns false. Unlike
+    /// addresses() this never holds more than the uncommitted accounts in
+    /// memory, so a page of results costs time proportional to its size.
+    void forEachAccount(dev::h256 const& _begin, std::function<bool(dev::h256 const&, dev::Address const&)> const& _f) const;
+
     dev::OverlayDB const& dbUtxo() const { return dbUTXO; }
 
 	dev::OverlayDB& dbUtxo() { return dbUTXO; }
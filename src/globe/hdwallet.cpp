@@ -35,7 +35,9 @@
 #include <secp256k1_mlsag.h>
 
 #include <algorithm>
+#include <atomic>
 #include <random>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/thread.hpp>
@@ -3989,78 +3991,52 @@ int CHDWallet::PlaceRealOutputs(std::vector<std::vector<int64_t> > &vMI, size_t
     return 0;
 };
 
-int CHDWallet::PickHidingOutputs(std::vector<std::vector<int64_t> > &vMI, size_t nSecretColumn, size_t nRingSize, std::set<int64_t> &setHave,
-    std::string &sError)
+int CHDWallet::PickHidingOutputs(std::vector<std::vector<std::vector<int64_t> > > &vMI, const std::vector<size_t> &vSecretColumns,
+    size_t nRingSize, std::set<int64_t> &setHave, std::string &sError)
 {
     if (nRingSize < MIN_RINGSIZE || nRingSize > MAX_RINGSIZE) {
         return wserrorN(1, sError, __func__, _("Ring size out of range [%d, %d]"), MIN_RINGSIZE, MAX_RINGSIZE);
     }
 
-    int nBestHeight = chainActive.Tip()->nHeight;
     const Consensus::Params& consensusParams = Params().GetConsensus();
-    size_t nInputs = vMI.size();
 
+    size_t nInputs = 0;
+    for (const auto &vSigMI : vMI) {
+        nInputs += vSigMI.size();
+    }
+
+    int nExtraDepth = gArgs.GetBoolArg("-regtest", false) ? -1 : 2; // if not on regtest pick outputs deeper than consensus checks to prevent banning
+
+    // The block index knows the last RCT output of every block, outputs up to
+    // that index at the required depth are all eligible and need no db reads.
     int64_t nLastRCTOutIndex = 0;
     {
         AssertLockHeld(cs_main);
-        nLastRCTOutIndex = chainActive.Tip()->nAnonOutputs;
+        nLastRCTOutIndex = GetLastSpendableRCTOutput(chainActive, consensusParams.nMinRCTOutputDepth + nExtraDepth);
     }
 
     if (nLastRCTOutIndex < (int64_t)(nInputs * nRingSize)) {
         return wserrorN(1, sError, __func__, _("Not enough anon outputs exist, last: %d, required: %d"), nLastRCTOutIndex, nInputs * nRingSize);
     }
 
-    int nExtraDepth = gArgs.GetBoolArg("-regtest", false) ? -1 : 2; // if not on regtest pick outputs deeper than consensus checks to prevent banning
-
     // Must add real outputs to setHave before adding the decoys.
-    for (size_t k = 0; k < nInputs; ++k)
+    for (size_t l = 0; l < vMI.size(); ++l)
+    for (size_t k = 0; k < vMI[l].size(); ++k)
     for (size_t i = 0; i < nRingSize; ++i) {
-        if (i == nSecretColumn) {
+        if (i == vSecretColumns[l]) {
             continue;
         }
 
-        int64_t nMinIndex = 1;
-        if (GetRandInt(100) < 50) { // 50% chance of selecting from the last 2400
-            nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nRCTOutSelectionGroup1);
-        } else
-        if (GetRandInt(100) < 70) { // further 70% chance of selecting from the last 24000
-            nMinIndex = std::max((int64_t)1, nLastRCTOutIndex - nRCTOutSelectionGroup2);
-        }
-
-        int64_t nLastDepthCheckPassed = 0;
         size_t j = 0;
         const static size_t nMaxTries = 1000;
         for (j = 0; j < nMaxTries; ++j) {
-            if (nLastRCTOutIndex <= nMinIndex) {
-                return wserrorN(1, sError, __func__, _("Not enough anon outputs exist, min: %d lastpick: %d, required: %d"), nMinIndex, nLastRCTOutIndex, nInputs * nRingSize);
-            }
-
-            int64_t nDecoy = nMinIndex + GetRand((nLastRCTOutIndex - nMinIndex) + 1);
+            int64_t nDecoy = SampleRCTDecoy(nLastRCTOutIndex, nRCTOutSelectionGroup1, nRCTOutSelectionGroup2);
 
-            if (setHave.count(nDecoy) > 0) {
-                if (nDecoy == nLastRCTOutIndex) {
-                    nLastRCTOutIndex--;
-                }
+            if (!setHave.insert(nDecoy).second) {
                 continue;
             }
 
-            if (nDecoy > nLastDepthCheckPassed) {
-                CAnonOutput ao;
-                if (!pblocktree->ReadRCTOutput(nDecoy, ao)) {
-                    return wserrorN(1, sError, __func__, _("Anon output not found in db, %d"), nDecoy);
-                }
-
-                if (ao.nBlockHeight > nBestHeight - (consensusParams.nMinRCTOutputDepth+nExtraDepth)) {
-                    if (nLastRCTOutIndex > nDecoy) {
-                        nLastRCTOutIndex = nDecoy-1;
-                    }
-                    continue;
-                }
-                nLastDepthCheckPassed = nDecoy;
-            }
-
-            vMI[k][i] = nDecoy;
-            setHave.insert(nDecoy);
+            vMI[l][k][i] = nDecoy;
             break;
         }
 
@@ -4072,6 +4048,93 @@ int CHDWallet::PickHidingOutputs(std::vector<std::vector<int64_t> > &vMI, size_t
     return 0;
 };
 
+/** Everything one MLSAG needs, owned by the job so signatures can be generated concurrently */
+struct CMLSAGSignJob
+{
+    size_t nCols = 0;
+    size_t nRows = 0;
+    size_t nSecretColumn = 0;
+    uint8_t randSeed[32];
+    uint256 preimage;
+
+    std::vector<uint8_t> vm;
+    std::vector<secp256k1_pedersen_commitment> vCommitments;
+    std::vector<CKey> vsk;
+    std::vector<const uint8_t*> vpBlinds;
+    std::vector<const uint8_t*> vpOutCommits;
+    size_t nOutBlinded = 0;
+    secp256k1_pedersen_commitment splitInputCommit;
+
+    uint8_t *pKeyImages = nullptr;
+    uint8_t *pDL = nullptr;
+
+    bool fPrepared = false;
+    int rv = 0;
+};
+
+static bool SignMLSAGJob(CMLSAGSignJob &job)
+{
+    size_t nInputs = job.nRows - 1;
+
+    std::vector<const uint8_t*> vpInCommits(job.nCols * nInputs);
+    for (size_t i = 0; i < vpInCommits.size(); ++i) {
+        vpInCommits[i] = job.vCommitments[i].data;
+    }
+
+    uint8_t blindSum[32];
+    memset(blindSum, 0, 32);
+    std::vector<const uint8_t*> vpsk(job.nRows);
+    for (size_t k = 0; k < nInputs; ++k) {
+        vpsk[k] = job.vsk[k].begin();
+    }
+    vpsk[job.nRows-1] = blindSum;
+
+    if (0 != (job.rv = secp256k1_prepare_mlsag(&job.vm[0], blindSum,
+        job.vpOutCommits.size(), job.nOutBlinded, job.nCols, job.nRows,
+        &vpInCommits[0], &job.vpOutCommits[0], &job.vpBlinds[0]))) {
+        return false;
+    }
+    job.fPrepared = true;
+
+    if (0 != (job.rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, job.pKeyImages, job.pDL, job.pDL + 32,
+        job.randSeed, job.preimage.begin(), job.nCols, job.nRows, job.nSecretColumn,
+        &vpsk[0], &job.vm[0]))) {
+        return false;
+    }
+
+    return true;
+};
+
+/** Sign all jobs on up to GetNumCores() threads, returns the index of the first failed job or vJobs.size() */
+static size_t RunMLSAGSignJobs(std::vector<CMLSAGSignJob> &vJobs)
+{
+    std::atomic<size_t> nNext(0);
+    std::vector<char> vFailed(vJobs.size(), 0);
+
+    auto worker = [&]() {
+        for (size_t n = nNext++; n < vJobs.size(); n = nNext++) {
+            vFailed[n] = !SignMLSAGJob(vJobs[n]);
+        }
+    };
+
+    size_t nThreads = std::min(vJobs.size(), (size_t)std::max(1, GetNumCores()));
+    std::vector<std::thread> vThreads;
+    for (size_t t = 1; t < nThreads; ++t) {
+        vThreads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : vThreads) {
+        thread.join();
+    }
+
+    for (size_t n = 0; n < vJobs.size(); ++n) {
+        if (vFailed[n]) {
+            return n;
+        }
+    }
+    return vJobs.size();
+};
+
 int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
     std::vector<CTempRecipient> &vecSend,
     CExtKeyAccount *sea, CStoredExtKey *pc,
@@ -4270,16 +4333,17 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             }
 
 
+            // Select decoys for all signatures together.
+            if (0 != PickHidingOutputs(vMI, vSecretColumns, nRingSize, setHave, sError)) {
+                return 1; // sError is set
+            }
+
             // Fill in dummy signatures for fee calculation.
             for (size_t l = 0; l < txNew.vin.size(); ++l) {
                 auto &txin = txNew.vin[l];
                 uint32_t nSigInputs, nSigRingSize;
                 txin.GetAnonInfo(nSigInputs, nSigRingSize);
 
-                if (0 != PickHidingOutputs(vMI[l], vSecretColumns[l], nSigRingSize, setHave, sError)) {
-                    return 1; // sError is set
-                }
-
                 std::vector<uint8_t> vPubkeyMatrixIndices;
 
                 for (size_t k = 0; k < nSigInputs; ++k)
@@ -4423,6 +4487,18 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             int rv;
             size_t nTotalInputs = 0;
 
+            // Read every ring member of every signature in one pass
+            std::set<int64_t> setRingIndices;
+            for (const auto &vSigMI : vMI)
+            for (const auto &vRow : vSigMI) {
+                setRingIndices.insert(vRow.begin(), vRow.end());
+            }
+
+            std::map<int64_t, CAnonOutput> mapAnonOutputs;
+            if (!pblocktree->ReadRCTOutputs(setRingIndices, mapAnonOutputs)) {
+                return wserrorN(1, sError, __func__, _("Anon output not found in db, %d - %d"), *setRingIndices.begin(), *setRingIndices.rbegin());
+            }
+
             for (size_t l = 0; l < txNew.vin.size(); ++l) {
                 auto &txin = txNew.vin[l];
 
@@ -4434,12 +4510,7 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
 
                 for (size_t k = 0; k < nSigInputs; ++k) {
                     size_t i = vSecretColumns[l];
-                    int64_t nIndex = vMI[l][k][i];
-
-                    CAnonOutput ao;
-                    if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
-                        return wserrorN(1, sError, __func__, _("Anon output not found in db, %d"), nIndex);
-                    }
+                    const CAnonOutput &ao = mapAnonOutputs[vMI[l][k][i]];
 
                     CKeyID idk = ao.pubkey.GetID();
                     CKey key;
@@ -4455,76 +4526,49 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             }
 
 
+            // Gather the keys and matrices, the signing maths runs on worker threads below.
+            std::vector<CMLSAGSignJob> vJobs(txNew.vin.size());
             for (size_t l = 0; l < txNew.vin.size(); ++l) {
                 auto &txin = txNew.vin[l];
+                auto &job = vJobs[l];
 
                 uint32_t nSigInputs, nSigRingSize;
                 txin.GetAnonInfo(nSigInputs, nSigRingSize);
 
-                size_t nCols = nSigRingSize;
-                size_t nRows = nSigInputs + 1;
-
-                uint8_t randSeed[32];
-                GetStrongRandBytes(randSeed, 32);
-
-                std::vector<CKey> vsk(nSigInputs);
-                std::vector<const uint8_t*> vpsk(nRows);
-
-                std::vector<uint8_t> vm(nCols * nRows * 33);
-                std::vector<secp256k1_pedersen_commitment> vCommitments;
-                vCommitments.reserve(nCols * nSigInputs);
-                std::vector<const uint8_t*> vpInCommits(nCols * nSigInputs);
-                std::vector<const uint8_t*> vpBlinds;
-
-                std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+                job.nCols = nSigRingSize;
+                job.nRows = nSigInputs + 1;
+                job.nSecretColumn = vSecretColumns[l];
+                GetStrongRandBytes(job.randSeed, 32);
 
+                job.vsk.resize(nSigInputs);
+                job.vm.resize(job.nCols * job.nRows * 33);
+                job.vCommitments.resize(job.nCols * nSigInputs);
+                job.pKeyImages = &txin.scriptData.stack[0][0];
 
                 for (size_t k = 0; k < nSigInputs; ++k)
-                for (size_t i = 0; i < nCols; ++i) {
-                    int64_t nIndex = vMI[l][k][i];
-
-                    CAnonOutput ao;
-                    if (!pblocktree->ReadRCTOutput(nIndex, ao)) {
-                        return wserrorN(1, sError, __func__, _("Anon output not found in db, %d"), nIndex);
-                    }
-
-                    memcpy(&vm[(i+k*nCols)*33], ao.pubkey.begin(), 33);
-                    vCommitments.push_back(ao.commitment);
-                    vpInCommits[i+k*nCols] = vCommitments.back().data;
+                for (size_t i = 0; i < job.nCols; ++i) {
+                    const CAnonOutput &ao = mapAnonOutputs[vMI[l][k][i]];
 
+                    memcpy(&job.vm[(i+k*job.nCols)*33], ao.pubkey.begin(), 33);
+                    job.vCommitments[i+k*job.nCols] = ao.commitment;
 
                     if (i == vSecretColumns[l]) {
                         CKeyID idk = ao.pubkey.GetID();
-                        if (!GetKey(idk, vsk[k])) {
+                        if (!GetKey(idk, job.vsk[k])) {
                             return wserrorN(1, sError, __func__, _("No key for anonoutput, %s"), HexStr(ao.pubkey.begin(), ao.pubkey.end()));
                         }
-                        vpsk[k] = vsk[k].begin();
-
-                        vpBlinds.push_back(&vInputBlinds[l][k * 32]);
-                        /*
-                        // Keyimage is required for the tx hash
-                        if (0 != (rv = secp256k1_get_keyimage(secp256k1_ctx_blind, &vKeyImages[k * 33], &vm[(i+k*nCols)*33], vpsk[k])))
-                            return errorN(1, sError, __func__, _("secp256k1_get_keyimage failed %d").c_str(), rv);
-                        */
+
+                        job.vpBlinds.push_back(&vInputBlinds[l][k * 32]);
                     }
                 }
 
-
-                uint8_t blindSum[32];
-                memset(blindSum, 0, 32);
-                vpsk[nRows-1] = blindSum;
-
                 std::vector<uint8_t> &vDL = txin.scriptWitness.stack[1];
 
                 if (txNew.vin.size() == 1) {
                     vDL.resize((1 + (nSigInputs+1) * nSigRingSize) * 32); // extra element for C, extra row for commitment row
-                    vpBlinds.insert(vpBlinds.end(), vpOutBlinds.begin(), vpOutBlinds.end());
-
-                    if (0 != (rv = secp256k1_prepare_mlsag(&vm[0], blindSum,
-                        vpOutCommits.size(), vpOutCommits.size(), nCols, nRows,
-                        &vpInCommits[0], &vpOutCommits[0], &vpBlinds[0]))) {
-                        return wserrorN(1, sError, __func__, _("secp256k1_prepare_mlsag failed %d"), rv);
-                    }
+                    job.vpBlinds.insert(job.vpBlinds.end(), vpOutBlinds.begin(), vpOutBlinds.end());
+                    job.vpOutCommits = vpOutCommits;
+                    job.nOutBlinded = vpOutCommits.size();
                 } else {
                     vDL.resize((1 + (nSigInputs+1) * nSigRingSize) * 32 + 33); // extra element for C extra, extra row for commitment row, split input commitment
 
@@ -4554,35 +4598,35 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
 
                     nTotalInputs += nSigInputs;
 
-                    secp256k1_pedersen_commitment splitInputCommit;
                     if (!secp256k1_pedersen_commit(secp256k1_ctx_blind,
-                        &splitInputCommit, (uint8_t*)vSplitCommitBlindingKeys[l].begin(),
+                        &job.splitInputCommit, (uint8_t*)vSplitCommitBlindingKeys[l].begin(),
                         nCommitValue, secp256k1_generator_h)) {
                         return wserrorN(1, sError, __func__, "secp256k1_pedersen_commit failed.");
                     }
 
 
-                    memcpy(&vDL[(1 + (nSigInputs+1) * nSigRingSize) * 32], splitInputCommit.data, 33);
-
-                    vpBlinds.emplace_back(vSplitCommitBlindingKeys[l].begin());
-                    const uint8_t *pSplitCommit = splitInputCommit.data;
-                    if (0 != (rv = secp256k1_prepare_mlsag(&vm[0], blindSum,
-                        1, 1, nCols, nRows,
-                        &vpInCommits[0], &pSplitCommit, &vpBlinds[0]))) {
-                        return wserrorN(1, sError, __func__, _("secp256k1_prepare_mlsag failed %d"), rv);
-                    }
+                    memcpy(&vDL[(1 + (nSigInputs+1) * nSigRingSize) * 32], job.splitInputCommit.data, 33);
 
-                    vpBlinds.pop_back();
+                    job.vpBlinds.emplace_back(vSplitCommitBlindingKeys[l].begin());
+                    job.vpOutCommits.push_back(job.splitInputCommit.data);
+                    job.nOutBlinded = 1;
                 }
+                job.pDL = &vDL[0];
+            }
 
+            // Key images are set and the signatures are witness data, the txid is final.
+            uint256 txhash = txNew.GetHash();
+            for (auto &job : vJobs) {
+                job.preimage = txhash;
+            }
 
-                uint256 txhash = txNew.GetHash();
-
-                if (0 != (rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, &vKeyImages[0], &vDL[0], &vDL[32],
-                    randSeed, txhash.begin(), nCols, nRows, vSecretColumns[l],
-                    &vpsk[0], &vm[0]))) {
-                    return wserrorN(1, sError, __func__, _("secp256k1_generate_mlsag failed %d"), rv);
+            size_t nFailed = RunMLSAGSignJobs(vJobs);
+            if (nFailed < vJobs.size()) {
+                const auto &job = vJobs[nFailed];
+                if (!job.fPrepared) {
+                    return wserrorN(1, sError, __func__, _("secp256k1_prepare_mlsag failed %d"), job.rv);
                 }
+                return wserrorN(1, sError, __func__, _("secp256k1_generate_mlsag failed %d"), job.rv);
             }
         }
 
@@ -7417,6 +7461,7 @@ bool CHDWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::
             // otherwise just for transaction history.
 
             AddToWallet(wtxNew);
+            UpdateStakeable(*wtxNew.tx);
 
             // Notify that old coins are spent
             for (const auto &txin : wtxNew.tx->vin)
@@ -7440,6 +7485,7 @@ bool CHDWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::
                 {
                     const uint256 hash = wtxNew.GetHash();
                     UnloadTransaction(hash);
+                    UpdateStakeable(*wtxNew.tx);
                     CHDWalletDB wdb(*database);
                     wdb.EraseTx(hash);
                     return false;
@@ -7463,6 +7509,7 @@ bool CHDWallet::CommitTransaction(CWalletTx &wtxNew, CTransactionRecord &rtx,
         WalletLogPrintf("CommitTransaction:\n%s", wtxNew.tx->ToString()); /* Continued */
 
         AddToRecord(rtx, *wtxNew.tx, nullptr, -1);
+        UpdateStakeable(*wtxNew.tx);
 
         if (fBroadcastTransactions)
         {
@@ -7475,6 +7522,7 @@ bool CHDWallet::CommitTransaction(CWalletTx &wtxNew, CTransactionRecord &rtx,
                 {
                     const uint256 hash = wtxNew.GetHash();
                     UnloadTransaction(hash);
+                    UpdateStakeable(*wtxNew.tx);
                     CHDWalletDB wdb(*database);
                     wdb.EraseTxRecord(hash);
                     wdb.EraseStoredTx(hash);
@@ -10184,6 +10232,9 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
                 rtx.SetAbandoned();
                 walletdb.WriteTxRecord(now, rtx);
                 NotifyTransactionChanged(this, now, CT_UPDATED);
+
+                for (const auto &prevout : rtx.vin)
+                    UpdateStakeableOutputs(prevout.hash);
             };
 
         } else
@@ -10217,6 +10268,7 @@ bool CHDWallet::AbandonTransaction(const uint256 &hashTx)
                         it->second.MarkDirty();
                     }
                 };
+                UpdateStakeable(*wtx.tx);
             };
         } else
         {
@@ -10286,6 +10338,9 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx)
                 rtx.blockHash = hashBlock;
                 walletdb.WriteTxRecord(now, rtx);
 
+                for (const auto &prevout : rtx.vin)
+                    UpdateStakeableOutputs(prevout.hash);
+
                 // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
                 TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
                 while (iter != mapTxSpends.end() && iter->first.hash == now)
@@ -10331,6 +10386,7 @@ void CHDWallet::MarkConflicted(const uint256 &hashBlock, const uint256 &hashTx)
                         it->second.MarkDirty();
                     }
                 };
+                UpdateStakeable(*wtx.tx);
             };
 
             continue;
@@ -497,8 +497,9 @@ public:
 
     int PlaceRealOutputs(std::vector<std::vector<int64_t> > &vMI, size_t &nSecretColumn, size_t nRingSize, std::set<int64_t> &setHave,
         const std::vector<std::pair<MapRecords_t::const_iterator,unsigned int> > &vCoins, std::vector<uint8_t> &vInputBlinds, std::string &sError);
-    int PickHidingOutputs(std::vector<std::vector<int64_t> > &vMI, size_t nSecretColumn, size_t nRingSize, std::set<int64_t> &setHave,
-        std::string &sError);
+    /** Select decoys for the rings of all signatures in a transaction from the outputs deep enough to spend */
+    int PickHidingOutputs(std::vector<std::vector<std::vector<int64_t> > > &vMI, const std::vector<size_t> &vSecretColumns,
+        size_t nRingSize, std::set<int64_t> &setHave, std::string &sError);
 
     int AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
         std::vector<CTempRecipient> &vecSend,
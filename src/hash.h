@@ -206,6 +206,65 @@ uint256 SerializeHash(const T& obj, int nType=SER_GETHASH, int nVersion=PROTOCOL
     return ss.GetHash();
 }
 
+/** A writer stream (for serialization) that computes the 256-bit hashes of
+ *  several objects' serializations at once. Each object passed to operator<<
+ *  is hashed separately; GetHashes() hashes them together with SHA256DMulti.
+ */
+class CMultiHashWriter
+{
+private:
+    std::vector<unsigned char> buf;
+    std::vector<size_t> ends;
+
+    const int nType;
+    const int nVersion;
+public:
+
+    CMultiHashWriter(int nTypeIn, int nVersionIn) : nType(nTypeIn), nVersion(nVersionIn) {}
+
+    int GetType() const { return nType; }
+    int GetVersion() const { return nVersion; }
+
+    void write(const char *pch, size_t size) {
+        buf.insert(buf.end(), (const unsigned char*)pch, (const unsigned char*)pch + size);
+    }
+
+    // invalidates the object
+    std::vector<uint256> GetHashes() {
+        static_assert(sizeof(uint256) == CSHA256::OUTPUT_SIZE, "uint256 must be a plain 32-byte array");
+        std::vector<const unsigned char*> inputs(ends.size());
+        std::vector<size_t> lens(ends.size());
+        size_t begin = 0;
+        for (size_t i = 0; i < ends.size(); ++i) {
+            inputs[i] = buf.data() + begin;
+            lens[i] = ends[i] - begin;
+            begin = ends[i];
+        }
+        std::vector<uint256> result(ends.size());
+        SHA256DMulti((unsigned char*)result.data(), inputs.data(), lens.data(), ends.size());
+        return result;
+    }
+
+    template<typename T>
+    CMultiHashWriter& operator<<(const T& obj) {
+        // Serialize to this stream, as a message of its own
+        ::Serialize(*this, obj);
+        ends.push_back(buf.size());
+        return (*this);
+    }
+};
+
+/** Compute the 256-bit hash of each object's serialization. */
+template<typename T>
+std::vector<uint256> SerializeHashes(const std::vector<T>& objs, int nType=SER_GETHASH, int nVersion=PROTOCOL_VERSION)
+{
+    CMultiHashWriter ss(nType, nVersion);
+    for (const T& obj : objs) {
+        ss << obj;
+    }
+    return ss.GetHashes();
+}
+
 unsigned int MurmurHash3(unsigned int nHashSeed, const std::vector<unsigned char>& vDataToHash);
 
 void BIP32Hash(const ChainCode &chainCode, unsigned int nChild, unsigned char header, const unsigned char data[32], unsigned char output[64]);
@@ -7,6 +7,8 @@
 #include <chainparams.h>
 #include <httpserver.h>
 #include <key_io.h>
+#include <msgstats.h>
+#include <net.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <random.h>
@@ -201,8 +203,11 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
                 return true;
             }
 
-            // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            // Send reply, serializing the result straight into the output buffer
+            req->WriteHeader("Content-Type", "application/json");
+            JSONRPCWriteReply(result, jreq.id, [req](const std::string& chunk) { req->AppendReply(chunk); });
+            req->WriteReply(HTTP_OK);
+            return true;
 
         // array of requests
         } else if (valRequest.isArray())
@@ -244,6 +249,91 @@ static bool InitRPCAuthentication()
     return true;
 }
 
+/** Append a histogram in the Prometheus text format, with bounds in seconds */
+static void AppendMetricsHistogram(std::string& out, const std::string& name, const std::string& labels, const LatencyHistogram& hist)
+{
+    uint64_t nCumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS - 1; i++) {
+        nCumulative += hist.Buckets()[i];
+        // Bucket bounds are exclusive, Prometheus' are inclusive
+        out += strprintf("%s_bucket{%s,le=\"%.6f\"} %u\n", name, labels, (LatencyHistogram::BucketBound(i) - 1) / 1e6, nCumulative);
+    }
+    out += strprintf("%s_bucket{%s,le=\"+Inf\"} %u\n", name, labels, hist.Count());
+    out += strprintf("%s_sum{%s} %.6f\n", name, labels, hist.TotalMicros() / 1e6);
+    out += strprintf("%s_count{%s} %u\n", name, labels, hist.Count());
+}
+
+/** Message handling and validation latencies for Prometheus style scrapers */
+static bool HTTPReq_Metrics(HTTPRequest* req, const std::string &)
+{
+    if (req->GetRequestMethod() != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "Metrics are served for GET requests only");
+        return false;
+    }
+    // Same credentials as JSON-RPC
+    std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
+    std::string strUser;
+    if (!authHeader.first || !RPCAuthorized(authHeader.second, strUser)) {
+        if (authHeader.first) {
+            LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
+            MilliSleep(250);
+        }
+        req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
+        req->WriteReply(HTTP_UNAUTHORIZED);
+        return false;
+    }
+
+    std::string out;
+    out += "# HELP qtum_p2p_message_handling_seconds Time spent handling P2P messages, by command\n";
+    out += "# TYPE qtum_p2p_message_handling_seconds histogram\n";
+    for (const auto& entry : g_msgstats.GetMessages()) {
+        AppendMetricsHistogram(out, "qtum_p2p_message_handling_seconds", strprintf("command=\"%s\"", entry.first), entry.second);
+    }
+    out += "# HELP qtum_validation_stage_seconds Time spent in validation entry points\n";
+    out += "# TYPE qtum_validation_stage_seconds histogram\n";
+    for (const auto& entry : g_msgstats.GetStages()) {
+        AppendMetricsHistogram(out, "qtum_validation_stage_seconds", strprintf("stage=\"%s\"", entry.first), entry.second);
+    }
+
+    std::vector<CNodeStats> vstats;
+    if (g_connman)
+        g_connman->GetNodeStats(vstats);
+    out += "# HELP qtum_peer_message_handling_seconds_total Time spent handling P2P messages, by peer and command\n";
+    out += "# TYPE qtum_peer_message_handling_seconds_total counter\n";
+    for (const CNodeStats& stats : vstats) {
+        for (const auto& entry : stats.mapProcessTimePerMsgCmd) {
+            out += strprintf("qtum_peer_message_handling_seconds_total{peer=\"%d\",command=\"%s\"} %.6f\n", stats.nodeid, entry.first, entry.second.TotalMicros() / 1e6);
+        }
+    }
+    out += "# HELP qtum_peer_messages_handled_total P2P messages handled, by peer and command\n";
+    out += "# TYPE qtum_peer_messages_handled_total counter\n";
+    for (const CNodeStats& stats : vstats) {
+        for (const auto& entry : stats.mapProcessTimePerMsgCmd) {
+            out += strprintf("qtum_peer_messages_handled_total{peer=\"%d\",command=\"%s\"} %u\n", stats.nodeid, entry.first, entry.second.Count());
+        }
+    }
+    out += "# HELP qtum_peer_bytes_received_total Bytes received, by peer and command\n";
+    out += "# TYPE qtum_peer_bytes_received_total counter\n";
+    for (const CNodeStats& stats : vstats) {
+        for (const auto& entry : stats.mapRecvBytesPerMsgCmd) {
+            if (entry.second > 0)
+                out += strprintf("qtum_peer_bytes_received_total{peer=\"%d\",command=\"%s\"} %u\n", stats.nodeid, entry.first, entry.second);
+        }
+    }
+    out += "# HELP qtum_peer_bytes_sent_total Bytes sent, by peer and command\n";
+    out += "# TYPE qtum_peer_bytes_sent_total counter\n";
+    for (const CNodeStats& stats : vstats) {
+        for (const auto& entry : stats.mapSendBytesPerMsgCmd) {
+            if (entry.second > 0)
+                out += strprintf("qtum_peer_bytes_sent_total{peer=\"%d\",command=\"%s\"} %u\n", stats.nodeid, entry.first, entry.second);
+        }
+    }
+
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, out);
+    return true;
+}
+
 bool StartHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
@@ -251,6 +341,8 @@ bool StartHTTPRPC()
         return false;
 
     RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    if (gArgs.GetBoolArg("-rpcmetrics", DEFAULT_RPC_METRICS))
+        RegisterHTTPHandler("/metrics", true, HTTPReq_Metrics);
 #ifdef ENABLE_WALLET
     // ifdef can be removed once we switch to better endpoint support and API versioning
     RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
@@ -270,6 +362,7 @@ void StopHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Stopping HTTP RPC server\n");
     UnregisterHTTPHandler("/", true);
+    UnregisterHTTPHandler("/metrics", true);
 #ifdef ENABLE_WALLET
     UnregisterHTTPHandler("/wallet/", false);
 #endif
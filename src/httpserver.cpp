@@ -14,7 +14,9 @@
 #include <sync.h>
 #include <ui_interface.h>
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,6 +34,8 @@
 
 #include <support/events.h>
 
+#include <boost/algorithm/string.hpp>
+
 #ifdef EVENT__HAVE_NETINET_IN_H
 #include <netinet/in.h>
 #ifdef _XOPEN_SOURCE_EXTENDED
@@ -62,6 +66,15 @@ private:
     HTTPRequestHandler func;
 };
 
+/** Histogram bucket for a latency in microseconds */
+static size_t LatencyBucket(int64_t nMicros)
+{
+    size_t i = 0;
+    while (i < HTTP_LATENCY_BUCKETS - 1 && nMicros > HTTP_LATENCY_BOUNDS_MS[i] * 1000)
+        ++i;
+    return i;
+}
+
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
  */
@@ -72,13 +85,22 @@ private:
     /** Mutex protects entire object */
     std::mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
+    /** Work items with the time (in microseconds) they were queued */
+    std::deque<std::pair<std::unique_ptr<WorkItem>, int64_t>> queue;
     bool running;
     size_t maxDepth;
+    uint64_t nProcessed;
+    uint64_t nRejected;
+    std::array<uint64_t, HTTP_LATENCY_BUCKETS> waitTime;
+    std::array<uint64_t, HTTP_LATENCY_BUCKETS> runTime;
 
 public:
     explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+                                 maxDepth(_maxDepth),
+                                 nProcessed(0),
+                                 nRejected(0),
+                                 waitTime{},
+                                 runTime{}
     {
     }
     /** Precondition: worker threads have all stopped (they have been joined).
@@ -91,9 +113,10 @@ public:
     {
         std::unique_lock<std::mutex> lock(cs);
         if (queue.size() >= maxDepth) {
+            ++nRejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queue.emplace_back(std::unique_ptr<WorkItem>(item), GetTimeMicros());
         cond.notify_one();
         return true;
     }
@@ -102,18 +125,38 @@ public:
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            int64_t nTimeStart;
             {
                 std::unique_lock<std::mutex> lock(cs);
                 while (running && queue.empty())
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
+                nTimeStart = GetTimeMicros();
+                ++waitTime[LatencyBucket(nTimeStart - queue.front().second)];
+                i = std::move(queue.front().first);
                 queue.pop_front();
             }
             (*i)();
+            int64_t nTimeRun = GetTimeMicros() - nTimeStart;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                ++runTime[LatencyBucket(nTimeRun)];
+                ++nProcessed;
+            }
         }
     }
+    /** Copy the counters into info */
+    void GetInfo(HTTPWorkQueueInfo& info)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        info.depth = queue.size();
+        info.maxDepth = maxDepth;
+        info.processed = nProcessed;
+        info.rejected = nRejected;
+        info.waitTime = waitTime;
+        info.runTime = runTime;
+    }
     /** Interrupt and exit loops */
     void Interrupt()
     {
@@ -143,8 +186,19 @@ static struct event_base* eventBase = nullptr;
 struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = nullptr;
+/** A work queue with its own worker threads, serving one class of requests */
+struct HTTPWorkLane
+{
+    std::string name;
+    int threads;
+    std::unique_ptr<WorkQueue<HTTPClosure>> queue;
+    //! JSON-RPC methods served by this lane
+    std::set<std::string> methods;
+    //! URI prefixes served by this lane
+    std::vector<std::string> prefixes;
+};
+//! Work lanes, the default lane (-rpcthreads, -rpcworkqueue) first
+static std::vector<HTTPWorkLane> workLanes;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -210,6 +264,146 @@ static std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+static bool IsJSONSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/** Skip a JSON string starting at its opening quote, nullptr if it does not end */
+static const char* SkipJSONString(const char* p, const char* end)
+{
+    for (++p; p != end; ++p) {
+        if (*p == '\\') {
+            if (++p == end)
+                return nullptr;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return nullptr;
+}
+
+/** Skip a JSON value without checking it, nullptr if it does not end */
+static const char* SkipJSONValue(const char* p, const char* end)
+{
+    if (p == end)
+        return nullptr;
+    if (*p == '"')
+        return SkipJSONString(p, end);
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p != end) {
+            if (*p == '"') {
+                p = SkipJSONString(p, end);
+                if (!p)
+                    return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                ++depth;
+            } else if ((*p == '}' || *p == ']') && --depth == 0) {
+                return p + 1;
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+    const char* literal = p;
+    while (p != end && *p != ',' && *p != '}' && *p != ']' && !IsJSONSpace(*p))
+        ++p;
+    return p == literal ? nullptr : p;
+}
+
+/**
+ * Find the JSON-RPC method name in a request body without consuming it.
+ * Only the members of the top level request object are looked at, values
+ * are skipped rather than parsed. A batch, an escaped key or anything
+ * unexpected yields an empty string.
+ */
+static std::string PeekRPCMethod(struct evhttp_request* req)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = evbuffer_get_length(buf);
+    // Linearizing here is free for the handler, ReadBody does the same.
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return "";
+    const char* end = data + size;
+
+    const char* p = data;
+    while (p != end && IsJSONSpace(*p))
+        ++p;
+    if (p == end || *p != '{')
+        return "";
+    ++p;
+
+    static const std::string key = "method";
+    while (true) {
+        while (p != end && IsJSONSpace(*p))
+            ++p;
+        if (p == end || *p != '"')
+            return "";
+        const char* keyBegin = p + 1;
+        p = SkipJSONString(p, end);
+        if (!p)
+            return "";
+        const char* keyEnd = p - 1;
+        if (std::find(keyBegin, keyEnd, '\\') != keyEnd)
+            return "";
+        while (p != end && IsJSONSpace(*p))
+            ++p;
+        if (p == end || *p != ':')
+            return "";
+        ++p;
+        while (p != end && IsJSONSpace(*p))
+            ++p;
+        if (key.compare(0, key.size(), keyBegin, keyEnd - keyBegin) == 0)
+            break;
+        p = SkipJSONValue(p, end);
+        if (!p)
+            return "";
+        while (p != end && IsJSONSpace(*p))
+            ++p;
+        if (p == end || *p != ',')
+            return "";
+        ++p;
+    }
+
+    if (p == end || *p != '"')
+        return "";
+    ++p;
+    const char* nameEnd = std::find(p, end, '"');
+    if (nameEnd == end || nameEnd - p > 64 || std::find(p, nameEnd, '\\') != nameEnd)
+        return "";
+    return std::string(p, nameEnd);
+}
+
+/** Choose the work lane for a request: URI prefixes first, then the JSON-RPC method */
+static HTTPWorkLane& SelectWorkLane(struct evhttp_request* req, const std::string& strURI, HTTPRequest::RequestMethod method)
+{
+    if (workLanes.size() == 1)
+        return workLanes.front();
+
+    for (HTTPWorkLane& lane : workLanes) {
+        for (const std::string& prefix : lane.prefixes) {
+            if (strURI.compare(0, prefix.size(), prefix) == 0)
+                return lane;
+        }
+    }
+    if (method == HTTPRequest::POST) {
+        std::string strMethod = PeekRPCMethod(req);
+        if (!strMethod.empty()) {
+            for (HTTPWorkLane& lane : workLanes) {
+                if (lane.methods.count(strMethod))
+                    return lane;
+            }
+        }
+    }
+    return workLanes.front();
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -259,12 +453,17 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        assert(!workLanes.empty());
+        HTTPWorkLane& lane = SelectWorkLane(req, strURI, hreq->GetRequestMethod());
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (lane.queue->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            if (&lane == &workLanes.front()) {
+                LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            } else {
+                LogPrintf("WARNING: request rejected because http work queue depth exceeded in lane %s, it can be increased with the -rpcworklane= setting\n", lane.name);
+            }
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
@@ -329,9 +528,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, const std::string& name)
 {
-    RenameThread("bitcoin-httpworker");
+    RenameThread(name.c_str());
     queue->Run();
 }
 
@@ -348,6 +547,50 @@ static void libevent_log_cb(int severity, const char *msg)
         LogPrint(BCLog::LIBEVENT, "libevent: %s\n", msg);
 }
 
+/** Set up the extra work lanes given with -rpcworklane */
+static bool InitHTTPWorkLanes()
+{
+    for (const std::string& strLane : gArgs.GetArgs("-rpcworklane")) {
+        std::vector<std::string> parts;
+        boost::split(parts, strLane, boost::is_any_of(":"));
+        int32_t threads = 0;
+        int32_t depth = 0;
+        if (parts.size() != 4 || parts[0].empty() || !ParseInt32(parts[1], &threads) || threads < 1 ||
+            !ParseInt32(parts[2], &depth) || depth < 1 || parts[3].empty()) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf("Invalid -rpcworklane=%s. Expected <name>:<threads>:<depth>:<method|/prefix>[,...]", strLane),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        for (const HTTPWorkLane& other : workLanes) {
+            if (other.name == parts[0]) {
+                uiInterface.ThreadSafeMessageBox(
+                    strprintf("Duplicate work lane name in -rpcworklane=%s", strLane),
+                    "", CClientUIInterface::MSG_ERROR);
+                return false;
+            }
+        }
+
+        HTTPWorkLane lane;
+        lane.name = parts[0];
+        lane.threads = threads;
+        lane.queue.reset(new WorkQueue<HTTPClosure>(depth));
+        std::vector<std::string> targets;
+        boost::split(targets, parts[3], boost::is_any_of(","));
+        for (const std::string& target : targets) {
+            if (target.empty())
+                continue;
+            if (target[0] == '/')
+                lane.prefixes.push_back(target);
+            else
+                lane.methods.insert(target);
+        }
+        LogPrintf("HTTP: creating work lane %s with %d threads and depth %d\n", lane.name, lane.threads, depth);
+        workLanes.push_back(std::move(lane));
+    }
+    return true;
+}
+
 bool InitHTTPServer()
 {
     if (!InitHTTPAllowList())
@@ -399,7 +642,15 @@ bool InitHTTPServer()
     int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    assert(workLanes.empty());
+    workLanes.emplace_back();
+    workLanes.back().name = "default";
+    workLanes.back().threads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    workLanes.back().queue.reset(new WorkQueue<HTTPClosure>(workQueueDepth));
+    if (!InitHTTPWorkLanes()) {
+        workLanes.clear();
+        return false;
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -427,14 +678,16 @@ static std::vector<std::thread> g_thread_http_workers;
 void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    LogPrintf("HTTP: starting %d worker threads\n", workLanes.front().threads);
     std::packaged_task<bool(event_base*)> task(ThreadHTTP);
     threadResult = task.get_future();
     threadHTTP = std::thread(std::move(task), eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
+    for (const HTTPWorkLane& lane : workLanes) {
+        std::string threadName = &lane == &workLanes.front() ? "bitcoin-httpworker" : "bitcoin-http-" + lane.name;
+        for (int i = 0; i < lane.threads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, lane.queue.get(), threadName);
+        }
     }
 }
 
@@ -449,21 +702,20 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (workQueue)
-        workQueue->Interrupt();
+    for (HTTPWorkLane& lane : workLanes)
+        lane.queue->Interrupt();
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (workQueue) {
+    if (!workLanes.empty()) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread: g_thread_http_workers) {
             thread.join();
         }
         g_thread_http_workers.clear();
-        delete workQueue;
-        workQueue = nullptr;
+        workLanes.clear();
     }
     if (eventBase) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
@@ -492,6 +744,21 @@ void StopHTTPServer()
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo()
+{
+    // The lanes are set up before the RPC server starts and torn down after
+    // it stops, so they can be read without further locking.
+    std::vector<HTTPWorkQueueInfo> vInfo;
+    for (HTTPWorkLane& lane : workLanes) {
+        HTTPWorkQueueInfo info;
+        info.name = lane.name;
+        info.threads = lane.threads;
+        lane.queue->GetInfo(info);
+        vInfo.push_back(std::move(info));
+    }
+    return vInfo;
+}
+
 struct event_base* EventBase()
 {
     return eventBase;
@@ -692,13 +959,46 @@ void HTTPRequest::Chunk(const std::string& chunk) {
  * Replies must be sent in the main loop in the main http thread,
  * this cannot be done from worker threads.
  */
+void HTTPRequest::AppendReply(const std::string& strData)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, strData.data(), strData.size());
+}
+
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
     assert(!replySent && req);
-    // Send event to main http thread to send reply message
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
     evbuffer_add(evb, strReply.data(), strReply.size());
+    SendReply(nStatus);
+}
+
+static void ReleaseReplyBuffer(const void* data, size_t datalen, void* extra)
+{
+    delete static_cast<std::vector<unsigned char>*>(extra);
+}
+
+void HTTPRequest::WriteReply(int nStatus, std::vector<unsigned char>&& vchReply)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    if (!vchReply.empty()) {
+        std::vector<unsigned char>* pvchReply = new std::vector<unsigned char>(std::move(vchReply));
+        if (evbuffer_add_reference(evb, pvchReply->data(), pvchReply->size(), ReleaseReplyBuffer, pvchReply) != 0) {
+            evbuffer_add(evb, pvchReply->data(), pvchReply->size());
+            delete pvchReply;
+        }
+    }
+    SendReply(nStatus);
+}
+
+void HTTPRequest::SendReply(int nStatus)
+{
+    // Send event to main http thread to send reply message
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, nullptr, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
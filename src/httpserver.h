@@ -5,7 +5,9 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <array>
 #include <string>
+#include <vector>
 #include <stdint.h>
 #include <functional>
 #include <mutex>
@@ -53,6 +55,30 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
  */
 struct event_base* EventBase();
 
+/** Upper bounds (in milliseconds) of the work queue latency histogram buckets.
+ * One more bucket counts everything slower than the last bound.
+ */
+static const int64_t HTTP_LATENCY_BOUNDS_MS[] = {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000};
+static const size_t HTTP_LATENCY_BUCKETS = sizeof(HTTP_LATENCY_BOUNDS_MS) / sizeof(HTTP_LATENCY_BOUNDS_MS[0]) + 1;
+
+/** Snapshot of one HTTP work queue and its worker threads */
+struct HTTPWorkQueueInfo
+{
+    std::string name;
+    int threads = 0;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+    uint64_t processed = 0;
+    uint64_t rejected = 0;
+    //! Time requests spent waiting for a worker
+    std::array<uint64_t, HTTP_LATENCY_BUCKETS> waitTime{};
+    //! Time the handler took to run
+    std::array<uint64_t, HTTP_LATENCY_BUCKETS> runTime{};
+};
+
+/** Return the state of all work queues, the default queue first */
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo();
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
@@ -69,6 +95,7 @@ private:
 
     void startDetectClientClose();
     void waitClientClose();
+    void SendReply(int nStatus);
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -129,6 +156,18 @@ public:
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
 
+    /**
+     * Append data to the reply body without sending it, so a large body can
+     * be produced piecewise. Finish the reply with WriteReply.
+     */
+    void AppendReply(const std::string& strData);
+
+    /**
+     * Write HTTP reply, handing the body to libevent without copying it.
+     * The buffer is released once the reply has been sent.
+     */
+    void WriteReply(int nStatus, std::vector<unsigned char>&& vchReply);
+
     /**
      * Start chunk transfer. Assume to be 200.
      */
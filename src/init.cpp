@@ -9,8 +9,10 @@
 
 #include <init.h>
 
+#include <anon.h>
 #include <addrman.h>
 #include <amount.h>
+#include <blind.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -71,6 +73,7 @@
 #endif
 
 bool fFeeEstimatesInitialized = false;
+static bool fSigCachesInitialized = false;
 static const bool DEFAULT_PROXYRANDOMIZE = true;
 static const bool DEFAULT_REST_ENABLE = false;
 static const bool DEFAULT_STOPAFTERBLOCKIMPORT = false;
@@ -232,6 +235,10 @@ void Shutdown()
         DumpMempool();
     }
 
+    if (fSigCachesInitialized && gArgs.GetBoolArg("-persistsigcache", DEFAULT_PERSIST_SIGCACHE)) {
+        DumpSigCaches();
+    }
+
     if (fFeeEstimatesInitialized)
     {
         ::feeEstimator.FlushUnconfirmed();
@@ -384,6 +391,7 @@ void SetupServerArgs()
     gArgs.AddArg("-par=<n>", strprintf("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-persistmempool", strprintf("Whether to save the mempool on shutdown and load on restart (default: %u)", DEFAULT_PERSIST_MEMPOOL), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-persistsigcache", strprintf("Whether to save the signature and script execution caches on shutdown and load them on restart (default: %u)", DEFAULT_PERSIST_SIGCACHE), false, OptionsCategory::OPTIONS);
 #ifndef WIN32
     gArgs.AddArg("-pid=<file>", strprintf("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)", BITCOIN_PID_FILENAME), false, OptionsCategory::OPTIONS);
 #else
@@ -429,6 +437,7 @@ void SetupServerArgs()
     gArgs.AddArg("-proxy=<ip:port>", "Connect through SOCKS5 proxy", false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-proxyrandomize", strprintf("Randomize credentials for every proxy connection. This enables Tor stream isolation (default: %u)", DEFAULT_PROXYRANDOMIZE), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-seednode=<ip>", "Connect to a node to retrieve peer addresses, and disconnect. This option can be specified multiple times to connect to multiple nodes.", false, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-socketevents=<mode>", strprintf("Socket readiness notification mechanism, select or epoll where available (default: %s)", DEFAULT_SOCKETEVENTS), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-timeout=<n>", strprintf("Specify connection timeout in milliseconds (minimum: 1, default: %d)", DEFAULT_CONNECT_TIMEOUT), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-torcontrol=<ip>:<port>", strprintf("Tor control port to use if onion listening enabled (default: %s)", DEFAULT_TOR_CONTROL), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-torpassword=<pass>", "Tor control port password (default: empty)", false, OptionsCategory::CONNECTION);
@@ -454,11 +463,21 @@ void SetupServerArgs()
     gArgs.AddArg("-zmqpubhashtx=<address>", "Enable publish hash transaction in <address>", false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawblock=<address>", "Enable publish raw block in <address>", false, OptionsCategory::ZMQ);
     gArgs.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubrawreceipt=<address>", "Enable publish raw contract receipts of connected blocks in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpublogs=<address>", "Enable publish contract logs of connected blocks in <address>", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpublogsaddress=<hex>", "Only publish logs emitted by this contract address (can be specified multiple times)", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpublogstopic=<hex>", "Only publish logs carrying this topic (can be specified multiple times)", false, OptionsCategory::ZMQ);
+    gArgs.AddArg("-zmqpubkeyimage=<address>", "Enable publish RingCT key images spent or unspent by connected and disconnected blocks in <address>", false, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
     hidden_args.emplace_back("-zmqpubrawblock=<address>");
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
+    hidden_args.emplace_back("-zmqpubrawreceipt=<address>");
+    hidden_args.emplace_back("-zmqpublogs=<address>");
+    hidden_args.emplace_back("-zmqpublogsaddress=<hex>");
+    hidden_args.emplace_back("-zmqpublogstopic=<hex>");
+    hidden_args.emplace_back("-zmqpubkeyimage=<address>");
 #endif
 
     gArgs.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), true, OptionsCategory::DEBUG_TEST);
@@ -485,6 +504,7 @@ void SetupServerArgs()
     gArgs.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)", true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-maxproofcachesize=<n>", strprintf("Limit the cache of verified range proofs and MLSAGs to <n> MiB (default: %u)", DEFAULT_MAX_PROOF_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-minmempoolgaslimit=<limit>", strprintf("The minimum transaction gas limit we are willing to accept into the mempool (default: %s)",MEMPOOL_MIN_GAS_LIMIT), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtxfee=<amt>", strprintf("Maximum total fees (in %s) to use in a single wallet transaction or raw transaction; setting this too low may abort large transactions (default: %s)",
@@ -520,6 +540,7 @@ void SetupServerArgs()
     gArgs.AddArg("-rest", strprintf("Accept public REST requests (default: %u)", DEFAULT_REST_ENABLE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcallowip=<ip>", "Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcauth=<userpw>", "Username and hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcauth. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times", false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchconcurrency=<n>", strprintf("Execute up to <n> read-only calls of a JSON-RPC batch, such as getrawtransaction or gettransactionreceipt, in parallel. 1 executes batches serially (default: %d)", DEFAULT_RPC_BATCH_CONCURRENCY), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcbind=<addr>[:port]", "Bind to given address to listen for JSON-RPC connections. This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -rpcallowip has been specified, 0.0.0.0 and :: i.e., all addresses)", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpccookiefile=<loc>", "Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpassword=<pw>", "Password for JSON-RPC connections", false, OptionsCategory::RPC);
@@ -528,7 +549,9 @@ void SetupServerArgs()
     gArgs.AddArg("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT), true, OptionsCategory::RPC);
     gArgs.AddArg("-rpcthreads=<n>", strprintf("Set the number of threads to service RPC calls (default: %d)", DEFAULT_HTTP_THREADS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcuser=<user>", "Username for JSON-RPC connections", false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcmetrics", strprintf("Serve P2P message handling and validation latencies on /metrics in the Prometheus text format, using the RPC credentials (default: %u)", DEFAULT_RPC_METRICS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), true, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcworklane=<name>:<threads>:<depth>:<targets>", "Serve the comma separated RPC methods and URI prefixes (starting with /) in <targets> from a separate work queue of <depth> requests with <threads> threads of its own, e.g. fast:2:64:getblockcount,sendrawtransaction,/rest/chaininfo. This option can be specified multiple times", false, OptionsCategory::RPC);
     gArgs.AddArg("-server", "Accept command line and JSON-RPC commands", false, OptionsCategory::RPC);
 
 #if HAVE_DECL_DAEMON
@@ -1189,6 +1212,17 @@ bool AppInitParameterInteraction()
             }
         }
     }
+
+#if ENABLE_ZMQ
+    for (const std::string& strAddress : gArgs.GetArgs("-zmqpublogsaddress")) {
+        if (strAddress.size() != 40 || !IsHex(strAddress))
+            return InitError(strprintf(_("Invalid contract address for -zmqpublogsaddress: '%s'"), strAddress));
+    }
+    for (const std::string& strTopic : gArgs.GetArgs("-zmqpublogstopic")) {
+        if (strTopic.size() != 64 || !IsHex(strTopic))
+            return InitError(strprintf(_("Invalid topic for -zmqpublogstopic: '%s'"), strTopic));
+    }
+#endif
     return true;
 }
 
@@ -1280,11 +1314,18 @@ bool AppInitMain()
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitProofCache();
+    if (gArgs.GetBoolArg("-persistsigcache", DEFAULT_PERSIST_SIGCACHE)) {
+        LoadSigCaches();
+    }
+    fSigCachesInitialized = true;
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i=0; i<nScriptCheckThreads-1; i++)
+            threadGroup.create_thread(&ThreadTxPreCheck);
     }
 
     // Start the lightweight task scheduler thread
@@ -1605,6 +1646,18 @@ bool AppInitMain()
                     pblocktree->WriteFlag("logevents", fLogEvents);
                 }
 
+                // Anon outputs indexed by older versions have no precomputed MLSAG points
+                if (!pblocktree->UpgradeRCTOutputPoints(chainActive.Tip() ? chainActive.Tip()->nAnonOutputs : 0)) {
+                    strLoadError = _("Error upgrading block index database");
+                    break;
+                }
+
+                // Each key image spends a distinct anon output, so their count bounds it
+                if (!LoadKeyImageFilter(chainActive.Tip() ? chainActive.Tip()->nAnonOutputs : 0)) {
+                    strLoadError = _("Error loading block database");
+                    break;
+                }
+
                 if (!fReset) {
                     // Note that RewindBlockIndex MUST run even if we're about to -reindex-chainstate.
                     // It both disconnects blocks based on chainActive, and drops block data in
@@ -1788,6 +1841,11 @@ bool AppInitMain()
     connOptions.nReceiveFloodSize = 1000*gArgs.GetArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = gArgs.GetArgs("-addnode");
 
+    std::string strSocketEvents = gArgs.GetArg("-socketevents", DEFAULT_SOCKETEVENTS);
+    if (!ParseSocketEventsMode(strSocketEvents, connOptions.socketEventsMode)) {
+        return InitError(strprintf(_("Unsupported -socketevents mode: '%s'"), strSocketEvents));
+    }
+
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
 
@@ -0,0 +1,81 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <msgstats.h>
+
+#include <crypto/common.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+CMsgStats g_msgstats;
+
+void LatencyHistogram::Add(int64_t nMicros)
+{
+    if (nMicros < 0)
+        nMicros = 0;
+    ++nCount;
+    nTotalMicros += nMicros;
+    nMaxMicros = std::max(nMaxMicros, nMicros);
+    ++vBuckets[std::min<size_t>(CountBits(nMicros), BUCKETS - 1)];
+}
+
+int64_t LatencyHistogram::BucketBound(size_t i)
+{
+    return i < BUCKETS - 1 ? int64_t{1} << i : 0;
+}
+
+int64_t LatencyHistogram::Quantile(double q) const
+{
+    if (nCount == 0)
+        return 0;
+    uint64_t nRank = std::max<uint64_t>(1, std::ceil(q * nCount));
+    uint64_t nSeen = 0;
+    for (size_t i = 0; i < BUCKETS - 1; i++) {
+        nSeen += vBuckets[i];
+        if (nSeen >= nRank)
+            return std::min(BucketBound(i), nMaxMicros);
+    }
+    return nMaxMicros;
+}
+
+std::string ValidationStageName(ValidationStage stage)
+{
+    switch (stage) {
+    case ValidationStage::PROCESS_NEW_BLOCK: return "processnewblock";
+    case ValidationStage::ACCEPT_TO_MEMORY_POOL: return "accepttomemorypool";
+    case ValidationStage::VERIFY_MLSAG: return "verifymlsag";
+    case ValidationStage::PRE_VALIDATE_TRANSACTION: return "prevalidatetransaction";
+    }
+    assert(false);
+}
+
+void CMsgStats::RecordMessage(const std::string& strCommand, int64_t nMicros)
+{
+    LOCK(cs);
+    mapMessages[strCommand].Add(nMicros);
+}
+
+void CMsgStats::RecordStage(ValidationStage stage, int64_t nMicros)
+{
+    LOCK(cs);
+    vStages[static_cast<size_t>(stage)].Add(nMicros);
+}
+
+mapMsgCmdLatency CMsgStats::GetMessages() const
+{
+    LOCK(cs);
+    return mapMessages;
+}
+
+std::map<std::string, LatencyHistogram> CMsgStats::GetStages() const
+{
+    LOCK(cs);
+    std::map<std::string, LatencyHistogram> mapStages;
+    for (size_t i = 0; i < VALIDATION_STAGE_COUNT; i++) {
+        mapStages[ValidationStageName(static_cast<ValidationStage>(i))] = vStages[i];
+    }
+    return mapStages;
+}
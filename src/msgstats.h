@@ -0,0 +1,99 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_MSGSTATS_H
+#define BITCOIN_MSGSTATS_H
+
+#include <sync.h>
+#include <utiltime.h>
+
+#include <array>
+#include <map>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Latency histogram with power of two buckets. Bucket i counts latencies
+ * below 2^i microseconds that did not fit into bucket i-1; the last bucket
+ * counts everything slower.
+ */
+class LatencyHistogram
+{
+public:
+    static const size_t BUCKETS = 24;
+
+    LatencyHistogram() : nCount(0), nTotalMicros(0), nMaxMicros(0), vBuckets{} {}
+
+    void Add(int64_t nMicros);
+
+    uint64_t Count() const { return nCount; }
+    int64_t TotalMicros() const { return nTotalMicros; }
+    int64_t MaxMicros() const { return nMaxMicros; }
+    const std::array<uint64_t, BUCKETS>& Buckets() const { return vBuckets; }
+
+    /** Exclusive upper bound of bucket i in microseconds, 0 for the last, unbounded bucket */
+    static int64_t BucketBound(size_t i);
+
+    /**
+     * Estimate of the q-quantile (0 < q <= 1) in microseconds: the upper
+     * bound of the bucket it falls in, capped at the slowest latency seen.
+     */
+    int64_t Quantile(double q) const;
+
+private:
+    uint64_t nCount;
+    int64_t nTotalMicros;
+    int64_t nMaxMicros;
+    std::array<uint64_t, BUCKETS> vBuckets;
+};
+
+typedef std::map<std::string, LatencyHistogram> mapMsgCmdLatency; // command, handling time
+
+/** Validation entry points whose latency is recorded */
+enum class ValidationStage
+{
+    PROCESS_NEW_BLOCK,
+    ACCEPT_TO_MEMORY_POOL,
+    VERIFY_MLSAG,
+    PRE_VALIDATE_TRANSACTION,
+};
+static const size_t VALIDATION_STAGE_COUNT = 4;
+
+std::string ValidationStageName(ValidationStage stage);
+
+/** Process wide P2P message handling and validation stage latencies */
+class CMsgStats
+{
+public:
+    void RecordMessage(const std::string& strCommand, int64_t nMicros);
+    void RecordStage(ValidationStage stage, int64_t nMicros);
+
+    mapMsgCmdLatency GetMessages() const;
+    /** Stage latencies by stage name */
+    std::map<std::string, LatencyHistogram> GetStages() const;
+
+private:
+    mutable CCriticalSection cs;
+    mapMsgCmdLatency mapMessages GUARDED_BY(cs);
+    std::array<LatencyHistogram, VALIDATION_STAGE_COUNT> vStages GUARDED_BY(cs);
+};
+
+extern CMsgStats g_msgstats;
+
+/** Records its own lifetime as one pass through a validation stage */
+class StageTimer
+{
+public:
+    explicit StageTimer(ValidationStage stageIn) : stage(stageIn), nTimeStart(GetTimeMicros()) {}
+    ~StageTimer() { g_msgstats.RecordStage(stage, GetTimeMicros() - nTimeStart); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    const ValidationStage stage;
+    const int64_t nTimeStart;
+};
+
+#endif // BITCOIN_MSGSTATS_H
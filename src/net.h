@@ -13,6 +13,7 @@
 #include <compat.h>
 #include <hash.h>
 #include <limitedmap.h>
+#include <msgstats.h>
 #include <netaddress.h>
 #include <policy/feerate.h>
 #include <protocol.h>
@@ -24,6 +25,7 @@
 
 #include <atomic>
 #include <deque>
+#include <map>
 #include <stdint.h>
 #include <thread>
 #include <memory>
@@ -82,6 +84,16 @@ static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
+/** How the socket handler thread waits for socket readiness */
+enum class SocketEventsMode {
+    SELECT,
+    EPOLL,
+};
+/** -socketevents default: epoll where the platform has it, select otherwise */
+extern const char * const DEFAULT_SOCKETEVENTS;
+/** Parse a -socketevents value. Returns false for unknown or unsupported modes. */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+
 // NOTE: When adjusting this, update rpcnet:setban's help ("24h")
 static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Default 24-hour ban
 
@@ -111,6 +123,40 @@ struct CSerializedNetMsg
     std::string command;
 };
 
+/**
+ * Payload buffers of large messages, recycled between messages and peers.
+ * A message whose header announces a large payload takes a buffer from the
+ * pool and receives into it at its final size, instead of growing its own
+ * buffer as the data arrives. The buffer goes back to the pool when the
+ * message is destroyed after processing.
+ *
+ * New memory is never committed ahead of the data a peer actually sent, so
+ * the pool only holds what earlier messages already used, up to nMaxBytes.
+ */
+class CNetRecvBufferPool
+{
+public:
+    /** Smaller payloads are received into their own buffer */
+    static const size_t MIN_BUFFER_SIZE = 256 * 1024;
+
+    explicit CNetRecvBufferPool(size_t nMaxBytesIn = 0) : nFreeBytes(0), nMaxBytes(nMaxBytesIn) {}
+
+    void SetMaxBytes(size_t nMaxBytesIn);
+
+    /** Swap a free buffer with capacity for at least nSize bytes into buf. Returns false if there is none. */
+    bool Get(size_t nSize, CSerializeData& buf);
+    /** Keep buf for reuse if it is large enough and the pool has room. buf is left empty when taken. */
+    void Put(CSerializeData& buf);
+
+    size_t FreeBytes() const;
+
+private:
+    mutable CCriticalSection cs;
+    std::multimap<size_t, CSerializeData> mapFree GUARDED_BY(cs); // by capacity
+    size_t nFreeBytes GUARDED_BY(cs);
+    size_t nMaxBytes GUARDED_BY(cs);
+};
+
 class NetEventsInterface;
 class CConnman
 {
@@ -143,6 +189,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        SocketEventsMode socketEventsMode = SocketEventsMode::SELECT;
     };
 
     void Init(const Options& connOptions) {
@@ -156,12 +203,16 @@ public:
         m_msgproc = connOptions.m_msgproc;
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
+        // Enough to recycle the payloads of a full process queue and a message
+        // still being received.
+        recvBufferPool.SetMaxBytes(2 * nReceiveFloodSize);
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
             nMaxOutboundLimit = connOptions.nMaxOutboundLimit;
         }
         vWhitelistedRange = connOptions.vWhitelistedRange;
+        socketEventsMode = connOptions.socketEventsMode;
         {
             LOCK(cs_vAddedNodes);
             vAddedNodes = connOptions.m_added_nodes;
@@ -313,6 +364,13 @@ public:
 
     void WakeMessageHandler();
 
+    /**
+     * Bring the readiness notifications requested for a node's socket in line
+     * with its send queue and receive pause. Only does work in epoll mode;
+     * select rebuilds its interest set on every iteration.
+     */
+    void SocketEventsUpdate(CNode* pnode);
+
     /** Attempts to obfuscate tx time through exponentially distributed emitting.
         Works assuming that a single interval is used.
         Variable intervals will result in privacy decrease.
@@ -337,6 +395,12 @@ private:
     void ThreadMessageHandler();
     void AcceptConnection(const ListenSocket& hListenSocket);
     void ThreadSocketHandler();
+    void SocketHandlerSelect();
+    void SocketHandlerEPoll();
+    void ServiceNode(CNode* pnode, bool recvSet, bool sendSet, bool errorSet);
+    void InactivityCheck(CNode* pnode);
+    bool SocketEventsStart();
+    void SocketEventsRegister(CNode* pnode);
     void ThreadDNSAddressSeed();
 
     uint64_t CalculateKeyedNetGroup(const CAddress& ad) const;
@@ -391,7 +455,14 @@ private:
     unsigned int nSendBufferMaxSize;
     unsigned int nReceiveFloodSize;
 
+    CNetRecvBufferPool recvBufferPool;
+
     std::vector<ListenSocket> vhListenSocket;
+    SocketEventsMode socketEventsMode;
+    /** epoll instance watching the listen sockets and all node sockets, or -1 */
+    int epollfd;
+    /** Last time (in seconds) the epoll loop ran the inactivity checks */
+    int64_t nLastInactivityCheck;
     std::atomic<bool> fNetworkActive;
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
@@ -554,6 +625,7 @@ public:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     uint64_t nRecvBytes;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
+    mapMsgCmdLatency mapProcessTimePerMsgCmd;
     bool fWhitelisted;
     double dPingTime;
     double dPingWait;
@@ -573,6 +645,7 @@ class CNetMessage {
 private:
     mutable CHash256 hasher;
     mutable uint256 data_hash;
+    CNetRecvBufferPool* m_recv_pool;
 public:
     bool in_data;                   // parsing header (false) or data (true)
 
@@ -585,7 +658,7 @@ public:
 
     int64_t nTime;                  // time (in microseconds) of message receipt.
 
-    CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn) : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn) {
+    CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn, CNetRecvBufferPool* recv_pool = nullptr) : m_recv_pool(recv_pool), hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn) {
         hdrbuf.resize(24);
         in_data = false;
         nHdrPos = 0;
@@ -593,6 +666,12 @@ public:
         nTime = 0;
     }
 
+    // Moves only: the payload buffer may belong to a pool.
+    CNetMessage(CNetMessage&&) = default;
+    CNetMessage& operator=(CNetMessage&&) = default;
+
+    ~CNetMessage();
+
     bool complete() const
     {
         if (!in_data)
@@ -628,6 +707,8 @@ public:
     CCriticalSection cs_vSend;
     CCriticalSection cs_hSocket;
     CCriticalSection cs_vRecv;
+    /** Events currently registered for hSocket in epoll mode */
+    uint32_t nSocketEvents GUARDED_BY(cs_hSocket);
 
     CCriticalSection cs_vProcessMsg;
     std::list<CNetMessage> vProcessMsg;
@@ -682,6 +763,9 @@ protected:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
 
+    CCriticalSection cs_processTime;
+    mapMsgCmdLatency mapProcessTimePerMsgCmd GUARDED_BY(cs_processTime);
+
 public:
     uint256 hashContinue;
     std::atomic<int> nStartingHeight;
@@ -750,6 +834,7 @@ private:
     const int nMyStartingHeight;
     int nSendVersion;
     std::list<CNetMessage> vRecvMsg;  // Used only by SocketHandler thread
+    CNetRecvBufferPool* m_recv_pool;   // Set by CConnman, may be null
 
     mutable CCriticalSection cs_addrName;
     std::string addrName;
@@ -857,6 +942,9 @@ public:
 
     void CloseSocketDisconnect();
 
+    /** Record the time spent handling a message from this peer, here and process wide */
+    void RecordProcessTime(const std::string& strCommand, int64_t nMicros);
+
     void copyStats(CNodeStats &stats);
 
     ServiceFlags GetLocalServices() const
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <amount.h>
+#include <hash.h>
 #include <script/script.h>
 #include <serialize.h>
 #include <uint256.h>
@@ -56,6 +57,96 @@ inline bool IsGlobeTxVersion(int nVersion)
     return (nVersion & 0xFF) >= GLOBE_TXN_VERSION;
 }
 
+/**
+ * Reads a transaction from an underlying stream while hashing the bytes read,
+ * so the txid and witness hash are known without serializing the transaction
+ * again. The txid is hashed from the serialization without witness data, in
+ * which range proofs are empty vectors and the input witnesses of Globe
+ * transactions are left out; those parts are marked by the deserialization
+ * code through BeginTxWitnessData/EndTxWitnessData. The bytes before the first
+ * witness field are the same in both, they are hashed once and the witness
+ * hasher starts from a copy of the txid hasher there.
+ */
+template<typename Source>
+class CTxHashReader
+{
+private:
+    Source* source;
+    CHash256 hasher;      //!< All bytes read, once witness data was seen
+    CHash256 hasher_txid; //!< Bytes of the serialization without witness data
+    bool fHaveWitnessData = false;
+    bool fInWitness = false;
+    bool fCanonical = true;
+
+public:
+    explicit CTxHashReader(Source* source_) : source(source_) {}
+
+    int GetType() const { return source->GetType(); }
+    int GetVersion() const { return source->GetVersion(); }
+
+    void read(char* pch, size_t nSize)
+    {
+        source->read(pch, nSize);
+        if (fHaveWitnessData) {
+            hasher.Write((const unsigned char*)pch, nSize);
+        }
+        if (!fInWitness) {
+            hasher_txid.Write((const unsigned char*)pch, nSize);
+        }
+    }
+
+    template<typename T>
+    CTxHashReader<Source>& operator>>(T&& obj)
+    {
+        // Unserialize from this stream
+        ::Unserialize(*this, obj);
+        return (*this);
+    }
+
+    void BeginWitnessData()
+    {
+        if (!fHaveWitnessData) {
+            hasher = hasher_txid;
+            fHaveWitnessData = true;
+        }
+        fInWitness = true;
+    }
+
+    /** A witness field ended, the serialization without witness has an empty vector in its place */
+    void EndWitnessData()
+    {
+        static const unsigned char empty = 0;
+        fInWitness = false;
+        hasher_txid.Write(&empty, 1);
+    }
+
+    /** The bytes read do not map onto the txid serialization (the BIP144 extended format) */
+    void SetExtendedFormat() { fCanonical = false; }
+    bool IsCanonical() const { return fCanonical; }
+
+    // Both invalidate the object, GetHash is only valid if witness data was read
+    uint256 GetTxid()
+    {
+        uint256 result;
+        hasher_txid.Finalize(result.begin());
+        return result;
+    }
+    uint256 GetHash()
+    {
+        uint256 result;
+        hasher.Finalize(result.begin());
+        return result;
+    }
+};
+
+/** Hooks for CTxHashReader around data that is not part of the txid, other streams ignore them. */
+template<typename Stream> inline void BeginTxWitnessData(Stream& s) {}
+template<typename Stream> inline void EndTxWitnessData(Stream& s) {}
+template<typename Stream> inline void SetTxExtendedFormat(Stream& s) {}
+template<typename Source> inline void BeginTxWitnessData(CTxHashReader<Source>& s) { s.BeginWitnessData(); }
+template<typename Source> inline void EndTxWitnessData(CTxHashReader<Source>& s) { s.EndWitnessData(); }
+template<typename Source> inline void SetTxExtendedFormat(CTxHashReader<Source>& s) { s.SetExtendedFormat(); }
+
 /** An outpoint - a combination of a transaction hash and an index n into its vout */
 class COutPoint
 {
@@ -387,7 +478,9 @@ public:
         s >> vData;
         s >> *(CScriptBase*)(&scriptPubKey);
 
+        BeginTxWitnessData(s);
         s >> vRangeproof;
+        EndTxWitnessData(s);
     };
 
     bool PutValue(std::vector<uint8_t> &vchAmount) const override
@@ -451,7 +544,9 @@ public:
         s.read((char*)pk.ncbegin(), 33);
         s.read((char*)&commitment.data[0], 33);
         s >> vData;
+        BeginTxWitnessData(s);
         s >> vRangeproof;
+        EndTxWitnessData(s);
     };
 
     bool PutValue(std::vector<uint8_t> &vchAmount) const override
@@ -663,6 +758,7 @@ inline void UnserializeTransaction(TxType& tx, Stream& s) {
 
         if (fAllowWitness)
         {
+            BeginTxWitnessData(s);
             for (auto &txin : tx.vin)
                 s >> txin.scriptWitness.stack;
         };
@@ -686,6 +782,7 @@ inline void UnserializeTransaction(TxType& tx, Stream& s) {
         /* We read a dummy or an empty vin. */
         s >> flags;
         if (flags != 0) {
+            SetTxExtendedFormat(s);
             s >> tx.vin;
             s >> tx.vout;
         }
@@ -813,9 +910,20 @@ public:
     }
 
     /** This deserializing constructor is provided instead of an Unserialize method.
-     *  Unserialize is not possible, since it would require overwriting const fields. */
+     *  Unserialize is not possible, since it would require overwriting const fields.
+     *  The hashes are taken from the bytes read, see CTxHashReader. */
     template <typename Stream>
-    CTransaction(deserialize_type, Stream& s) : CTransaction(CMutableTransaction(deserialize, s)) {}
+    CTransaction(deserialize_type, Stream& s) : CTransaction(deserialize, CTxHashReader<Stream>(&s)) {}
+
+private:
+    template <typename Source>
+    CTransaction(deserialize_type, CTxHashReader<Source>&& reader) : CTransaction(CMutableTransaction(deserialize, reader), reader) {}
+
+    /** Convert a CMutableTransaction that was just read from reader, taking its hashes from the reader */
+    template <typename Source>
+    CTransaction(CMutableTransaction &&tx, CTxHashReader<Source>& reader);
+
+public:
 
     bool IsNull() const {
         return vin.empty() && vout.empty() && vpout.empty();
@@ -967,6 +1075,12 @@ struct CMutableTransaction
     }
 };
 
+template <typename Source>
+CTransaction::CTransaction(CMutableTransaction &&tx, CTxHashReader<Source>& reader)
+    : vin(std::move(tx.vin)), vout(std::move(tx.vout)), vpout(std::move(tx.vpout)), nVersion(tx.nVersion), nLockTime(tx.nLockTime),
+      hash{reader.IsCanonical() ? reader.GetTxid() : ComputeHash()},
+      m_witness_hash{!HasWitness() ? hash : reader.IsCanonical() ? reader.GetHash() : ComputeWitnessHash()} {}
+
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 static inline CTransactionRef MakeTransactionRef() { return std::make_shared<const CTransaction>(); }
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
@@ -3,33 +3,88 @@
 
 #include <primitives/transaction.h>
 
+#include <secp256k1_mlsag.h>
+
+class CAnonOutputPoints
+{
+// The decompressed pubkey and H(pubkey) of an anon output, computed once when
+// the output is connected so MLSAG verification skips the square roots for
+// ring members.
+public:
+    static const size_t SIZE = 128;
+
+    CAnonOutputPoints() { memset(data, 0, SIZE); };
+
+    uint8_t data[SIZE]; // pubkey x, y, H(pubkey) x, y
+
+    bool Set(const CCmpPubKey &pubkey)
+    {
+        return 0 == secp256k1_get_mlsag_points(data, pubkey.begin());
+    };
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        if (ser_action.ForRead())
+            s.read((char*)&data[0], SIZE);
+        else
+            s.write((char*)&data[0], SIZE);
+    };
+};
+
 class CAnonOutput
 {
 // Stored in txdb, key is 64bit index
 public:
-    CAnonOutput() : nBlockHeight(0), nCompromised(0) {};
+    // Version 0 records end after nCompromised, version 1 appends the version
+    // and the points. Outputs with an invalid pubkey keep version 0.
+    static const uint8_t VERSION_POINTS = 1;
+
+    CAnonOutput() : nBlockHeight(0), nCompromised(0), nVersion(0) {};
     CAnonOutput(CCmpPubKey pubkey_, secp256k1_pedersen_commitment commitment_, COutPoint &outpoint_, int nBlockHeight_, uint8_t nCompromised_)
-            : pubkey(pubkey_), commitment(commitment_), outpoint(outpoint_), nBlockHeight(nBlockHeight_), nCompromised(nCompromised_) {};
+            : pubkey(pubkey_), commitment(commitment_), outpoint(outpoint_), nBlockHeight(nBlockHeight_), nCompromised(nCompromised_), nVersion(0) {};
 
     CCmpPubKey pubkey;
     secp256k1_pedersen_commitment commitment;
     COutPoint outpoint;
     int nBlockHeight;
     uint8_t nCompromised;   // TODO: mark if output can be identified (spent with ringsize 1)
+    uint8_t nVersion;
+    CAnonOutputPoints points;
 
-    ADD_SERIALIZE_METHODS;
-    template <typename Stream, typename Operation>
-    inline void SerializationOp(Stream& s, Operation ser_action)
+    bool HavePoints() const { return nVersion >= VERSION_POINTS; };
+
+    /** Compute the points of pubkey, fails if it is not a valid key */
+    bool SetPoints()
     {
-        READWRITE(pubkey);
-        if (ser_action.ForRead())
-            s.read((char*)&commitment.data[0], 33);
-        else
-            s.write((char*)&commitment.data[0], 33);
+        if (!points.Set(pubkey))
+            return false;
+        nVersion = VERSION_POINTS;
+        return true;
+    };
 
-        READWRITE(outpoint);
-        READWRITE(nBlockHeight);
-        READWRITE(nCompromised);
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << pubkey;
+        s.write((const char*)&commitment.data[0], 33);
+        s << outpoint << nBlockHeight << nCompromised;
+        if (HavePoints())
+            s << nVersion << points;
+    };
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> pubkey;
+        s.read((char*)&commitment.data[0], 33);
+        s >> outpoint >> nBlockHeight >> nCompromised;
+        nVersion = 0;
+        if (!s.empty())
+            s >> nVersion;
+        if (HavePoints())
+            s >> points;
     };
 };
 
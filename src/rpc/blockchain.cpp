@@ -178,21 +178,21 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
 {
     AssertLockHeld(cs_main);
     UniValue result(UniValue::VOBJ);
-    result.pushKV("hash", blockindex->GetBlockHash().GetHex());
+    result.pushKVEnd("hash", blockindex->GetBlockHash().GetHex());
     int confirmations = -1;
     // Only report confirmations if the block is on the main chain
     if (chainActive.Contains(blockindex))
         confirmations = chainActive.Height() - blockindex->nHeight + 1;
-    result.pushKV("confirmations", confirmations);
-    result.pushKV("strippedsize", (int)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
-    result.pushKV("size", (int)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
-    result.pushKV("weight", (int)::GetBlockWeight(block));
-    result.pushKV("height", blockindex->nHeight);
-    result.pushKV("version", block.nVersion);
-    result.pushKV("versionHex", strprintf("%08x", block.nVersion));
-    result.pushKV("merkleroot", block.hashMerkleRoot.GetHex());
-    result.pushKV("hashStateRoot", block.hashStateRoot.GetHex()); // qtum
-    result.pushKV("hashUTXORoot", block.hashUTXORoot.GetHex()); // qtum
+    result.pushKVEnd("confirmations", confirmations);
+    result.pushKVEnd("strippedsize", (int)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
+    result.pushKVEnd("size", (int)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+    result.pushKVEnd("weight", (int)::GetBlockWeight(block));
+    result.pushKVEnd("height", blockindex->nHeight);
+    result.pushKVEnd("version", block.nVersion);
+    result.pushKVEnd("versionHex", strprintf("%08x", block.nVersion));
+    result.pushKVEnd("merkleroot", block.hashMerkleRoot.GetHex());
+    result.pushKVEnd("hashStateRoot", block.hashStateRoot.GetHex()); // qtum
+    result.pushKVEnd("hashUTXORoot", block.hashUTXORoot.GetHex()); // qtum
     UniValue txs(UniValue::VARR);
     for(const auto& tx : block.vtx)
     {
@@ -205,27 +205,27 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
         else
             txs.push_back(tx->GetHash().GetHex());
     }
-    result.pushKV("tx", txs);
-    result.pushKV("time", block.GetBlockTime());
-    result.pushKV("mediantime", (int64_t)blockindex->GetMedianTimePast());
-    result.pushKV("nonce", (uint64_t)block.nNonce);
-    result.pushKV("bits", strprintf("%08x", block.nBits));
-    result.pushKV("difficulty", GetDifficulty(blockindex));
-    result.pushKV("chainwork", blockindex->nChainWork.GetHex());
-    result.pushKV("nTx", (uint64_t)blockindex->nTx);
+    result.pushKVEnd("tx", std::move(txs));
+    result.pushKVEnd("time", block.GetBlockTime());
+    result.pushKVEnd("mediantime", (int64_t)blockindex->GetMedianTimePast());
+    result.pushKVEnd("nonce", (uint64_t)block.nNonce);
+    result.pushKVEnd("bits", strprintf("%08x", block.nBits));
+    result.pushKVEnd("difficulty", GetDifficulty(blockindex));
+    result.pushKVEnd("chainwork", blockindex->nChainWork.GetHex());
+    result.pushKVEnd("nTx", (uint64_t)blockindex->nTx);
 
     if (blockindex->pprev)
-        result.pushKV("previousblockhash", blockindex->pprev->GetBlockHash().GetHex());
+        result.pushKVEnd("previousblockhash", blockindex->pprev->GetBlockHash().GetHex());
     CBlockIndex *pnext = chainActive.Next(blockindex);
     if (pnext)
-        result.pushKV("nextblockhash", pnext->GetBlockHash().GetHex());
+        result.pushKVEnd("nextblockhash", pnext->GetBlockHash().GetHex());
 
-    result.pushKV("flags", strprintf("%s", blockindex->IsProofOfStake()? "proof-of-stake" : "proof-of-work"));
-    result.pushKV("proofhash", blockindex->hashProof.GetHex());
-    result.pushKV("modifier", blockindex->nStakeModifier.GetHex());
+    result.pushKVEnd("flags", strprintf("%s", blockindex->IsProofOfStake()? "proof-of-stake" : "proof-of-work"));
+    result.pushKVEnd("proofhash", blockindex->hashProof.GetHex());
+    result.pushKVEnd("modifier", blockindex->nStakeModifier.GetHex());
 
     if (block.IsProofOfStake())
-        result.pushKV("signature", HexStr(block.vchBlockSig.begin(), block.vchBlockSig.end()));	
+        result.pushKVEnd("signature", HexStr(block.vchBlockSig.begin(), block.vchBlockSig.end()));	
 
     return result;
 }
@@ -506,24 +506,24 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
     AssertLockHeld(mempool.cs);
 
     UniValue fees(UniValue::VOBJ);
-    fees.pushKV("base", ValueFromAmount(e.GetFee()));
-    fees.pushKV("modified", ValueFromAmount(e.GetModifiedFee()));
-    fees.pushKV("ancestor", ValueFromAmount(e.GetModFeesWithAncestors()));
-    fees.pushKV("descendant", ValueFromAmount(e.GetModFeesWithDescendants()));
-    info.pushKV("fees", fees);
-
-    info.pushKV("size", (int)e.GetTxSize());
-    info.pushKV("fee", ValueFromAmount(e.GetFee()));
-    info.pushKV("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
-    info.pushKV("time", e.GetTime());
-    info.pushKV("height", (int)e.GetHeight());
-    info.pushKV("descendantcount", e.GetCountWithDescendants());
-    info.pushKV("descendantsize", e.GetSizeWithDescendants());
-    info.pushKV("descendantfees", e.GetModFeesWithDescendants());
-    info.pushKV("ancestorcount", e.GetCountWithAncestors());
-    info.pushKV("ancestorsize", e.GetSizeWithAncestors());
-    info.pushKV("ancestorfees", e.GetModFeesWithAncestors());
-    info.pushKV("wtxid", mempool.vTxHashes[e.vTxHashesIdx].first.ToString());
+    fees.pushKVEnd("base", ValueFromAmount(e.GetFee()));
+    fees.pushKVEnd("modified", ValueFromAmount(e.GetModifiedFee()));
+    fees.pushKVEnd("ancestor", ValueFromAmount(e.GetModFeesWithAncestors()));
+    fees.pushKVEnd("descendant", ValueFromAmount(e.GetModFeesWithDescendants()));
+    info.pushKVEnd("fees", std::move(fees));
+
+    info.pushKVEnd("size", (int)e.GetTxSize());
+    info.pushKVEnd("fee", ValueFromAmount(e.GetFee()));
+    info.pushKVEnd("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
+    info.pushKVEnd("time", e.GetTime());
+    info.pushKVEnd("height", (int)e.GetHeight());
+    info.pushKVEnd("descendantcount", e.GetCountWithDescendants());
+    info.pushKVEnd("descendantsize", e.GetSizeWithDescendants());
+    info.pushKVEnd("descendantfees", e.GetModFeesWithDescendants());
+    info.pushKVEnd("ancestorcount", e.GetCountWithAncestors());
+    info.pushKVEnd("ancestorsize", e.GetSizeWithAncestors());
+    info.pushKVEnd("ancestorfees", e.GetModFeesWithAncestors());
+    info.pushKVEnd("wtxid", mempool.vTxHashes[e.vTxHashesIdx].first.ToString());
     const CTransaction& tx = e.GetTx();
     std::set<std::string> setDepends;
     for (const CTxIn& txin : tx.vin)
@@ -538,7 +538,7 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
         depends.push_back(dep);
     }
 
-    info.pushKV("depends", depends);
+    info.pushKVEnd("depends", std::move(depends));
 
     UniValue spent(UniValue::VARR);
     const CTxMemPool::txiter &it = mempool.mapTx.find(tx.GetHash());
@@ -547,7 +547,7 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
         spent.push_back(childiter->GetTx().GetHash().ToString());
     }
 
-    info.pushKV("spentby", spent);
+    info.pushKVEnd("spentby", std::move(spent));
 }
 
 UniValue mempoolToJSON(bool fVerbose)
@@ -966,8 +966,12 @@ static UniValue getblockheader(const JSONRPCRequest& request)
 
     if (!fVerbose)
     {
+        CBlockHeader header;
+        if (!pblockindex->GetBlockHeader(header)) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Can't read block signature from disk");
+        }
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << pblockindex->GetBlockHeader();
+        ssBlock << header;
         std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
         return strHex;
     }
@@ -1045,8 +1049,6 @@ static UniValue getblock(const JSONRPCRequest& request)
             + HelpExampleRpc("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"")
         );
 
-    LOCK(cs_main);
-
     std::string strHash = request.params[0].get_str();
     uint256 hash(uint256S(strHash));
 
@@ -1058,11 +1060,30 @@ static UniValue getblock(const JSONRPCRequest& request)
             verbosity = request.params[1].get_bool() ? 1 : 0;
     }
 
-    const CBlockIndex* pblockindex = LookupBlockIndex(hash);
-    if (!pblockindex) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    const CBlockIndex* pblockindex;
+    {
+        LOCK(cs_main);
+        pblockindex = LookupBlockIndex(hash);
+        if (!pblockindex) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        if (IsBlockPruned(pblockindex)) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+        }
+    }
+
+    if (verbosity <= 0 && RPCSerializationFlags() == 0)
+    {
+        // The network format matches the format on disk, return the stored bytes
+        std::vector<uint8_t> vchBlock;
+        if (!ReadRawBlockFromDisk(vchBlock, pblockindex, Params().MessageStart())) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+        }
+        return HexStr(vchBlock.begin(), vchBlock.end());
     }
 
+    LOCK(cs_main);
+
     const CBlock block = GetBlockChecked(pblockindex);
 
     if (verbosity <= 0)
@@ -1639,10 +1660,26 @@ UniValue listcontracts(const JSONRPCRequest& request)
 {
 	if (request.fHelp)
 		throw std::runtime_error(
-				"listcontracts (start maxDisplay)\n"
+				"listcontracts (start maxDisplay cursor)\n"
 				"\nArgument:\n"
 				"1. start     (numeric or string, optional) The starting account index, default 1\n"
 				"2. maxDisplay       (numeric or string, optional) Max accounts to list, default 20\n"
+				"3. cursor    (string, optional) Resume from this cursor instead of an index; \"\" for the first page.\n"
+				"                 start is ignored when a cursor is given\n"
+				"\nResult (without cursor):\n"
+				"{\n"
+				"  \"address\": balance, (numeric) Contract balance, one entry per contract\n"
+				"  ...\n"
+				"}\n"
+				"\nResult (with cursor):\n"
+				"{\n"
+				"  \"contracts\": {...},   (object) Contract balances as above\n"
+				"  \"next\": \"hex\"          (string, optional) Cursor for the next page, absent on the last page\n"
+				"}\n"
+				"\nExamples:\n"
+				+ HelpExampleCli("listcontracts", "1 20")
+				+ HelpExampleCli("listcontracts", "1 100 \"\"")
+				+ HelpExampleRpc("listcontracts", "1, 100, \"\"")
 		);
 
 	LOCK(cs_main);
@@ -1661,23 +1698,39 @@ UniValue listcontracts(const JSONRPCRequest& request)
 			throw JSONRPCError(RPC_TYPE_ERROR, "Invalid maxDisplay");
 	}
 
-	UniValue result(UniValue::VOBJ);
-
-	auto map = globalState->addresses();
-	int contractsCount=(int)map.size();
-
-	if (contractsCount>0 && start > contractsCount)
-		throw JSONRPCError(RPC_TYPE_ERROR, "start greater than max index "+ itostr(contractsCount));
-
-	int itStartPos=std::min(start-1,contractsCount);
-	int i=0;
-	for (auto it = std::next(map.begin(),itStartPos); it!=map.end(); it++)
-	{
-		result.pushKV(it->first.hex(),ValueFromAmount(CAmount(globalState->balance(it->first))));
-		i++;
-		if(i==maxDisplay)break;
+	// The cursor is the hashed address of the next account in trie order
+	bool fCursor = request.params.size() > 2 && !request.params[2].isNull();
+	dev::h256 begin;
+	if (fCursor && !request.params[2].get_str().empty())
+		begin = uintToh256(ParseHashV(request.params[2], "cursor"));
+
+	UniValue contracts(UniValue::VOBJ);
+	int nSkip = fCursor ? 0 : start-1;
+	int nSeen = 0;
+	dev::h256 next;
+	bool fMore = false;
+	globalState->forEachAccount(begin, [&](const dev::h256& hashed, const dev::Address& address) {
+		if (nSeen++ < nSkip)
+			return true;
+		if ((int)contracts.size() == maxDisplay) {
+			next = hashed;
+			fMore = true;
+			return false;
+		}
+		contracts.pushKVEnd(address.hex(), ValueFromAmount(CAmount(globalState->balance(address))));
+		return true;
+	});
+
+	if (!fCursor) {
+		if (nSeen>0 && start > nSeen)
+			throw JSONRPCError(RPC_TYPE_ERROR, "start greater than max index "+ itostr(nSeen));
+		return contracts;
 	}
 
+	UniValue result(UniValue::VOBJ);
+	result.pushKV("contracts", contracts);
+	if (fMore)
+		result.pushKV("next", h256Touint(next).GetHex());
 	return result;
 }
 
@@ -3060,7 +3113,7 @@ static const CRPCCommand commands[] =
     { "hidden",             "waitforblock",           &waitforblock,           {"blockhash","timeout"} },
     { "hidden",             "waitforblockheight",     &waitforblockheight,     {"height","timeout"} },
     { "hidden",             "syncwithvalidationinterfacequeue", &syncwithvalidationinterfacequeue, {} },
-    { "blockchain",         "listcontracts",          &listcontracts,          {"start", "maxDisplay"} },
+    { "blockchain",         "listcontracts",          &listcontracts,          {"start", "maxDisplay", "cursor"} },
     { "blockchain",         "gettransactionreceipt",  &gettransactionreceipt,  {"hash"} },
     { "blockchain",         "searchlogs",             &searchlogs,             {"fromBlock", "toBlock", "address", "topics"} },
 
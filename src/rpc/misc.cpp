@@ -290,6 +290,17 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCBlockIndexMemoryInfo()
+{
+    LOCK(cs_main);
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(mapBlockIndex.size()));
+    obj.pushKV("usage", uint64_t(BlockIndexMemoryUsage()));
+    obj.pushKV("pending_sigs", uint64_t(g_block_sigs.Size()));
+    obj.pushKV("load_time", nBlockIndexLoadTime);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -331,6 +342,12 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"blockindex\": {           (json object) Information about the in-memory block index\n"
+            "    \"entries\": xxxxx,       (numeric) Number of block index entries\n"
+            "    \"usage\": xxxxx,         (numeric) Estimated heap usage in bytes\n"
+            "    \"pending_sigs\": xxxxx,  (numeric) Block signatures held in memory until the next block index flush\n"
+            "    \"load_time\": xxxxx,     (numeric) Milliseconds taken to load the block index at startup\n"
             "  }\n"
             "}\n"
             "\nResult (mode \"mallocinfo\"):\n"
@@ -344,6 +361,7 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("blockindex", RPCBlockIndexMemoryInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -468,11 +486,71 @@ static UniValue getinfo_deprecated(const JSONRPCRequest& request)
     );
 }
 
+static UniValue getrpcworkqueues(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getrpcworkqueues\n"
+            "Returns the state of the HTTP work queues serving RPC and REST requests.\n"
+            "Besides the default queue there is one per -rpcworklane.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"bounds\": [ n, ... ],      (array) Upper bounds in milliseconds of the latency buckets. The last bucket of each histogram counts everything slower\n"
+            "  \"queues\": [\n"
+            "    {\n"
+            "      \"name\": \"xxxx\",         (string) Queue name, \"default\" for the -rpcthreads/-rpcworkqueue queue\n"
+            "      \"threads\": n,           (numeric) Number of worker threads\n"
+            "      \"depth\": n,             (numeric) Requests currently waiting\n"
+            "      \"maxdepth\": n,          (numeric) Maximum number of waiting requests\n"
+            "      \"processed\": n,         (numeric) Requests handled\n"
+            "      \"rejected\": n,          (numeric) Requests rejected because the queue was full\n"
+            "      \"waittime\": [ n, ... ], (array) Histogram of the time requests waited for a worker\n"
+            "      \"runtime\": [ n, ... ]   (array) Histogram of the time handlers took\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getrpcworkqueues", "")
+            + HelpExampleRpc("getrpcworkqueues", "")
+        );
+
+    UniValue bounds(UniValue::VARR);
+    for (int64_t nBound : HTTP_LATENCY_BOUNDS_MS)
+        bounds.push_back(nBound);
+
+    UniValue queues(UniValue::VARR);
+    for (const HTTPWorkQueueInfo& info : GetHTTPWorkQueueInfo()) {
+        UniValue waitTime(UniValue::VARR);
+        for (uint64_t nCount : info.waitTime)
+            waitTime.push_back(nCount);
+        UniValue runTime(UniValue::VARR);
+        for (uint64_t nCount : info.runTime)
+            runTime.push_back(nCount);
+
+        UniValue queue(UniValue::VOBJ);
+        queue.pushKV("name", info.name);
+        queue.pushKV("threads", info.threads);
+        queue.pushKV("depth", (uint64_t)info.depth);
+        queue.pushKV("maxdepth", (uint64_t)info.maxDepth);
+        queue.pushKV("processed", info.processed);
+        queue.pushKV("rejected", info.rejected);
+        queue.pushKV("waittime", waitTime);
+        queue.pushKV("runtime", runTime);
+        queues.push_back(queue);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("bounds", bounds);
+    ret.pushKV("queues", queues);
+    return ret;
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"} },
     { "control",            "logging",                &logging,                {"include", "exclude"}},
+    { "control",            "getrpcworkqueues",       &getrpcworkqueues,       {} },
     { "util",               "validateaddress",        &validateaddress,        {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys"} },
     { "util",               "verifymessage",          &verifymessage,          {"address","signature","message"} },
@@ -8,6 +8,7 @@
 #include <clientversion.h>
 #include <core_io.h>
 #include <validation.h>
+#include <msgstats.h>
 #include <net.h>
 #include <net_processing.h>
 #include <netbase.h>
@@ -392,6 +393,84 @@ static UniValue getnettotals(const JSONRPCRequest& request)
     return obj;
 }
 
+static UniValue LatencyToJSON(const LatencyHistogram& hist)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("count", hist.Count());
+    obj.pushKV("totaltime", hist.TotalMicros());
+    obj.pushKV("p50", hist.Quantile(0.5));
+    obj.pushKV("p99", hist.Quantile(0.99));
+    obj.pushKV("max", hist.MaxMicros());
+    return obj;
+}
+
+static UniValue LatencyMapToJSON(const std::map<std::string, LatencyHistogram>& mapLatency)
+{
+    UniValue obj(UniValue::VOBJ);
+    for (const auto& entry : mapLatency) {
+        if (entry.second.Count() > 0)
+            obj.pushKV(entry.first, LatencyToJSON(entry.second));
+    }
+    return obj;
+}
+
+static UniValue getnetmsgstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 0)
+        throw std::runtime_error(
+            "getnetmsgstats\n"
+            "\nReturns the time spent handling P2P messages, per message type and per peer,\n"
+            "and the time spent in the main validation entry points. Times are in microseconds,\n"
+            "percentiles are the upper bound of the power of two bucket they fall in.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"messages\": {          (json object) Handling time per message type, since startup\n"
+            "    \"msg\": {             (json object) One entry per message type handled\n"
+            "      \"count\": n,        (numeric) Number of messages handled\n"
+            "      \"totaltime\": n,    (numeric) Total handling time\n"
+            "      \"p50\": n,          (numeric) Median handling time\n"
+            "      \"p99\": n,          (numeric) 99th percentile handling time\n"
+            "      \"max\": n           (numeric) Slowest handling time\n"
+            "    }, ...\n"
+            "  },\n"
+            "  \"stages\": {            (json object) Time per validation stage (processnewblock,\n"
+            "    ...                    accepttomemorypool, verifymlsag, prevalidatetransaction),\n"
+            "                           same fields as above\n"
+            "  },\n"
+            "  \"peers\": [             (json array) Connected peers\n"
+            "    {\n"
+            "      \"id\": n,           (numeric) Peer index\n"
+            "      \"addr\": \"host:port\", (string) The IP address and port of the peer\n"
+            "      \"messages\": { ... } (json object) Handling time per message type for this peer\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getnetmsgstats", "")
+            + HelpExampleRpc("getnetmsgstats", "")
+       );
+    if(!g_connman)
+        throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
+
+    std::vector<CNodeStats> vstats;
+    g_connman->GetNodeStats(vstats);
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("messages", LatencyMapToJSON(g_msgstats.GetMessages()));
+    obj.pushKV("stages", LatencyMapToJSON(g_msgstats.GetStages()));
+
+    UniValue peers(UniValue::VARR);
+    for (const CNodeStats& stats : vstats) {
+        UniValue peer(UniValue::VOBJ);
+        peer.pushKV("id", stats.nodeid);
+        peer.pushKV("addr", stats.addrName);
+        peer.pushKV("messages", LatencyMapToJSON(stats.mapProcessTimePerMsgCmd));
+        peers.push_back(peer);
+    }
+    obj.pushKV("peers", peers);
+    return obj;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -635,6 +714,7 @@ static const CRPCCommand commands[] =
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       {"node"} },
     { "network",            "getnettotals",           &getnettotals,           {} },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         {} },
+    { "network",            "getnetmsgstats",         &getnetmsgstats,         {} },
     { "network",            "setban",                 &setban,                 {"subnet", "command", "bantime", "absolute"} },
     { "network",            "listbanned",             &listbanned,             {} },
     { "network",            "clearbanned",            &clearbanned,            {} },
@@ -50,6 +50,14 @@ std::string JSONRPCReply(const UniValue& result, const UniValue& error, const Un
     return reply.write() + "\n";
 }
 
+void JSONRPCWriteReply(const UniValue& result, const UniValue& id, const UniValue::WriteSink& sink)
+{
+    // Keys in the order JSONRPCReplyObj pushes them
+    sink("{\"result\":");
+    result.write(sink);
+    sink(",\"error\":null,\"id\":" + id.write() + "}\n");
+}
+
 UniValue JSONRPCError(int code, const std::string& message)
 {
     UniValue error(UniValue::VOBJ);
@@ -95,6 +95,8 @@ enum RPCErrorCode
 UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params, const UniValue& id);
 UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const UniValue& id);
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id);
+/** Write the same bytes as JSONRPCReply(result, NullUniValue, id) to sink in pieces, without copying result */
+void JSONRPCWriteReply(const UniValue& result, const UniValue& id, const UniValue::WriteSink& sink);
 UniValue JSONRPCError(int code, const std::string& message);
 
 /** Generate a new RPC authentication cookie and write it to disk */
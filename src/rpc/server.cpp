@@ -20,8 +20,14 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory> // for unique_ptr
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 static CCriticalSection cs_rpcWarmup;
 static bool fRPCRunning = false;
@@ -301,10 +307,89 @@ bool CRPCTable::appendCommand(const std::string& name, const CRPCCommand* pcmd)
     return true;
 }
 
+/**
+ * Helper threads for JSON-RPC batches. A batch hands out its concurrent
+ * elements through a shared index; the calling HTTP worker takes part too,
+ * so a batch always completes even if every helper is busy elsewhere.
+ */
+class RPCBatchWorkers
+{
+private:
+    std::mutex cs;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+    bool running = false;
+
+    void Run()
+    {
+        RenameThread("bitcoin-rpcbatch");
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                while (running && queue.empty())
+                    cond.wait(lock);
+                if (!running)
+                    break;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    void Start(int nThreads)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        running = true;
+        for (int i = 0; i < nThreads; i++)
+            threads.emplace_back(&RPCBatchWorkers::Run, this);
+    }
+
+    void Stop()
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            running = false;
+            queue.clear();
+            cond.notify_all();
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+        threads.clear();
+    }
+
+    size_t Size()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return threads.size();
+    }
+
+    void Submit(std::function<void()> task)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        if (!running)
+            return;
+        queue.push_back(std::move(task));
+        cond.notify_one();
+    }
+};
+
+static RPCBatchWorkers g_rpc_batch_workers;
+//! Elements of one batch executed at the same time, 1 executes batches serially
+static int g_rpc_batch_concurrency = DEFAULT_RPC_BATCH_CONCURRENCY;
+
 void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     fRPCRunning = true;
+    g_rpc_batch_concurrency = std::max((int)gArgs.GetArg("-rpcbatchconcurrency", DEFAULT_RPC_BATCH_CONCURRENCY), 1);
+    if (g_rpc_batch_concurrency > 1) {
+        LogPrintf("RPC: executing up to %d batch elements in parallel\n", g_rpc_batch_concurrency);
+        g_rpc_batch_workers.Start(g_rpc_batch_concurrency - 1);
+    }
     g_rpcSignals.Started();
 }
 
@@ -318,6 +403,7 @@ void InterruptRPC()
 void StopRPC()
 {
     LogPrint(BCLog::RPC, "Stopping RPC\n");
+    g_rpc_batch_workers.Stop();
     deadlineTimers.clear();
     DeleteAuthCookie();
     g_rpcSignals.Stopped();
@@ -452,12 +538,101 @@ static UniValue JSONRPCExecOne(const UniValue& req)
     return rpc_result;
 }
 
+/**
+ * Methods that only read state, so batch elements calling them may run in
+ * any order relative to each other. Elements calling anything else are
+ * executed in batch order, after everything before them has finished.
+ */
+static const std::unordered_set<std::string> setConcurrentBatchMethods = {
+    "callcontract",
+    "decodepsbt",
+    "decoderawtransaction",
+    "decodescript",
+    "fromhexaddress",
+    "getaccountinfo",
+    "getbestblockhash",
+    "getblock",
+    "getblockcount",
+    "getblockhash",
+    "getblockheader",
+    "getblockstats",
+    "gethexaddress",
+    "getmempoolentry",
+    "getrawtransaction",
+    "getstorage",
+    "gettransactionreceipt",
+    "gettxout",
+    "gettxoutproof",
+    "searchlogs",
+    "validateaddress",
+    "verifymessage",
+    "verifytxoutproof",
+};
+
+static bool IsConcurrentBatchElement(const UniValue& req)
+{
+    if (!req.isObject())
+        return false;
+    const UniValue& method = find_value(req, "method");
+    return method.isStr() && setConcurrentBatchMethods.count(method.get_str());
+}
+
+/** Shared by the threads working on one run of concurrent batch elements */
+struct BatchRun
+{
+    const UniValue& vReq;
+    std::vector<UniValue>& vResults;
+    const size_t nEnd;
+    std::atomic<size_t> nNext;
+    std::mutex cs;
+    std::condition_variable cond;
+    size_t nDone = 0;
+
+    BatchRun(const UniValue& vReqIn, std::vector<UniValue>& vResultsIn, size_t nBegin, size_t nEndIn)
+        : vReq(vReqIn), vResults(vResultsIn), nEnd(nEndIn), nNext(nBegin) {}
+
+    /** Execute elements until none are left. vReq and vResults are only
+     * touched for a claimed index, so a helper that starts after the run
+     * has completed does nothing. */
+    void Work()
+    {
+        size_t nIdx;
+        while ((nIdx = nNext++) < nEnd) {
+            vResults[nIdx] = JSONRPCExecOne(vReq[nIdx]);
+            std::unique_lock<std::mutex> lock(cs);
+            ++nDone;
+            cond.notify_all();
+        }
+    }
+};
+
 std::string JSONRPCExecBatch(const UniValue& vReq)
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+    std::vector<UniValue> vResults(vReq.size());
+    size_t nIdx = 0;
+    while (nIdx < vReq.size()) {
+        size_t nEnd = nIdx;
+        while (nEnd < vReq.size() && IsConcurrentBatchElement(vReq[nEnd]))
+            ++nEnd;
+
+        if (nEnd - nIdx > 1 && g_rpc_batch_concurrency > 1) {
+            auto run = std::make_shared<BatchRun>(vReq, vResults, nIdx, nEnd);
+            size_t nHelpers = std::min<size_t>(g_rpc_batch_concurrency - 1, nEnd - nIdx - 1);
+            for (size_t i = 0; i < nHelpers; i++)
+                g_rpc_batch_workers.Submit([run] { run->Work(); });
+            run->Work();
+            std::unique_lock<std::mutex> lock(run->cs);
+            run->cond.wait(lock, [&] { return run->nDone == nEnd - nIdx; });
+        } else {
+            nEnd = std::max(nEnd, nIdx + 1);
+            for (size_t i = nIdx; i < nEnd; i++)
+                vResults[i] = JSONRPCExecOne(vReq[i]);
+        }
+        nIdx = nEnd;
+    }
 
+    UniValue ret(UniValue::VARR);
+    ret.push_backV(vResults);
     return ret.write() + "\n";
 }
 
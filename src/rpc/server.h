@@ -21,6 +21,7 @@
 #include <condition_variable>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+static const int DEFAULT_RPC_BATCH_CONCURRENCY = 1;
 
 struct CUpdatedBlock
 {
@@ -57,6 +57,23 @@ public:
     {
         return setValid.setup_bytes(n);
     }
+
+    const uint256& GetNonce() const
+    {
+        return nonce;
+    }
+
+    void SetNonce(const uint256& nonceIn)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
+        nonce = nonceIn;
+    }
+
+    void ForEach(const std::function<void(const uint256&)>& fn)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
+        setValid.for_each(fn);
+    }
 };
 
 /* In previous versions of this code, signatureCache was a local static variable
@@ -80,6 +97,26 @@ void InitSignatureCache()
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+uint256 GetSignatureCacheNonce()
+{
+    return signatureCache.GetNonce();
+}
+
+void SetSignatureCacheNonce(const uint256& nonce)
+{
+    signatureCache.SetNonce(nonce);
+}
+
+void ForEachSignatureCacheEntry(const std::function<void(const uint256&)>& fn)
+{
+    signatureCache.ForEach(fn);
+}
+
+void AddSignatureCacheEntry(uint256 entry)
+{
+    signatureCache.Set(entry);
+}
+
 bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -8,6 +8,7 @@
 
 #include <script/interpreter.h>
 
+#include <functional>
 #include <vector>
 
 // DoS prevention: limit cache size to 32MB (over 1000000 entries on 64-bit
@@ -53,4 +54,13 @@ public:
 
 void InitSignatureCache();
 
+/** Access to the signature cache for saving it to disk and loading it back.
+ *  Entries are salted with the cache's nonce, so they are only meaningful
+ *  together with it; SetSignatureCacheNonce may only be called before any
+ *  entry is added. */
+uint256 GetSignatureCacheNonce();
+void SetSignatureCacheNonce(const uint256& nonce);
+void ForEachSignatureCacheEntry(const std::function<void(const uint256&)>& fn);
+void AddSignatureCacheEntry(uint256 entry);
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
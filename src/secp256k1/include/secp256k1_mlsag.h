@@ -13,6 +13,12 @@ int secp256k1_prepare_mlsag(uint8_t *m, uint8_t *sk,
     size_t nOuts, size_t nBlinded, size_t nCols, size_t nRows,
     const uint8_t **pcm_in, const uint8_t **pcm_out, const uint8_t **blinds);
 
+/** Write the affine coordinates x || y of the compressed pubkey pk and then
+ *  of its hash to curve point H(pk) to out[128], so secp256k1_verify_mlsag_points
+ *  can skip decompressing pk and hashing it. Returns 0 on success.
+ */
+int secp256k1_get_mlsag_points(uint8_t *out, const uint8_t *pk);
+
 int secp256k1_get_keyimage(const secp256k1_context *ctx, uint8_t *ki, const uint8_t *pk, const uint8_t *sk);
 
 int secp256k1_generate_mlsag(const secp256k1_context *ctx, 
@@ -24,6 +30,13 @@ int secp256k1_verify_mlsag(const secp256k1_context *ctx, const uint8_t *preimage
     size_t nCols, size_t nRows,
     const uint8_t *pk, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps);
 
+/** As secp256k1_verify_mlsag, with pkh[(col+(cols*row))*128] holding the output
+ *  of secp256k1_get_mlsag_points for every pk but those of the last row.
+ */
+int secp256k1_verify_mlsag_points(const secp256k1_context *ctx, const uint8_t *preimage,
+    size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *pkh, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,8 +57,22 @@ SECP256K1_API int secp256k1_pedersen_commitment_serialize(
     const secp256k1_pedersen_commitment* commit
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
-/** Initialize a context for usage with Pedersen commitments. */
-void secp256k1_pedersen_context_initialize(secp256k1_context* ctx);
+/** Initialize a context for usage with Pedersen commitments.
+ *
+ *  Precomputes a table of multiples of secp256k1_generator_h in the context,
+ *  which speeds up the value * H part of secp256k1_pedersen_commit,
+ *  secp256k1_rangeproof_sign, _verify and _rewind. Other generators, and
+ *  contexts without the table, use generic multiplication instead.
+ *  The table takes 16 KiB and is copied by secp256k1_context_clone.
+ *
+ *  Like secp256k1_context_randomize, this modifies the context and must not be
+ *  called while other threads use it.
+ *
+ *  Args:   ctx:    pointer to a context object (cannot be NULL)
+ */
+SECP256K1_API void secp256k1_pedersen_context_initialize(
+    secp256k1_context* ctx
+) SECP256K1_ARG_NONNULL(1);
 
 /** Generate a pedersen commitment.
  *  Returns 1: commitment successfully created.
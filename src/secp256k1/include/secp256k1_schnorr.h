@@ -48,6 +48,29 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify(
   const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Verify a set of signatures created by secp256k1_schnorr_sign at once.
+ *  The signatures are combined with randomizers derived from a hash of all
+ *  inputs, so the set verifies only if every signature does, at the cost of
+ *  one multi-scalar multiplication.
+ *  Returns: 1: all signatures are correct (or n is 0)
+ *           0: at least one signature is incorrect
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *           scratch:   scratch space used for the multi-scalar multiplication
+ *                      (can be NULL, which verifies the terms one by one)
+ *  In:      sig64:     array of n pointers to 64-byte signatures
+ *           msg32:     array of n pointers to 32-byte message hashes
+ *           pubkey:    array of n pointers to the public keys to verify with
+ *           n:         the number of signatures
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify_batch(
+  const secp256k1_context* ctx,
+  secp256k1_scratch_space *scratch,
+  const unsigned char * const *sig64,
+  const unsigned char * const *msg32,
+  const secp256k1_pubkey * const *pubkey,
+  size_t n
+) SECP256K1_ARG_NONNULL(1);
+
 /** Recover an EC public key from a Schnorr signature created using
  *  secp256k1_schnorr_sign.
  *  Returns: 1: public key successfully recovered (which guarantees a correct
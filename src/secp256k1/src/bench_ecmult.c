@@ -0,0 +1,127 @@
+/**********************************************************************
+ * Copyright (c) 2018 The Particl Core developers                     *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+#include <stdio.h>
+
+#include "include/secp256k1.h"
+
+#include "util.h"
+#include "hash_impl.h"
+#include "num_impl.h"
+#include "field_impl.h"
+#include "group_impl.h"
+#include "scalar_impl.h"
+#include "ecmult_impl.h"
+#include "bench.h"
+#include "secp256k1.c"
+
+#define POINTS 1024
+#define ITERS 8192
+
+typedef struct {
+    /* Setup once in advance */
+    secp256k1_context* ctx;
+    secp256k1_scratch_space* scratch;
+    secp256k1_scalar* scalars;
+    secp256k1_ge* pubkeys;
+    secp256k1_gej* output;
+
+    /* Changes per test */
+    size_t count;
+    int includes_g;
+} bench_data;
+
+static int bench_callback(secp256k1_scalar* sc, secp256k1_ge* ge, size_t idx, void* arg) {
+    bench_data* data = (bench_data*)arg;
+    *sc = data->scalars[idx];
+    *ge = data->pubkeys[idx];
+    return 1;
+}
+
+static void bench_ecmult(void* arg) {
+    bench_data* data = (bench_data*)arg;
+    size_t count = data->count;
+    size_t iters = ITERS / count;
+    size_t iter;
+
+    for (iter = 0; iter < iters; ++iter) {
+        CHECK(secp256k1_ecmult_multi_var(&data->ctx->ecmult_ctx, data->scratch, &data->output[iter], data->includes_g ? &data->scalars[0] : NULL, bench_callback, arg, count - data->includes_g));
+    }
+}
+
+/* The same sum computed with one secp256k1_ecmult per point */
+static void bench_ecmult_single(void* arg) {
+    bench_data* data = (bench_data*)arg;
+    size_t count = data->count;
+    size_t iters = ITERS / count;
+    size_t iter;
+
+    for (iter = 0; iter < iters; ++iter) {
+        CHECK(secp256k1_ecmult_multi_var(&data->ctx->ecmult_ctx, NULL, &data->output[iter], data->includes_g ? &data->scalars[0] : NULL, bench_callback, arg, count - data->includes_g));
+    }
+}
+
+static void run_test(bench_data* data, size_t count, int includes_g) {
+    char str[64];
+    data->count = count;
+    data->includes_g = includes_g;
+
+    sprintf(str, includes_g ? "ecmult_multi_%ig" : "ecmult_multi_%i", (int)count);
+    run_benchmark(str, bench_ecmult, NULL, NULL, data, 10, count * (ITERS / count));
+    sprintf(str, includes_g ? "ecmult_single_%ig" : "ecmult_single_%i", (int)count);
+    run_benchmark(str, bench_ecmult_single, NULL, NULL, data, 10, count * (ITERS / count));
+}
+
+int main(int argc, char **argv) {
+    bench_data data;
+    secp256k1_gej gej;
+    secp256k1_scalar g_sc;
+    size_t i, p;
+
+    (void)argc;
+    (void)argv;
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 8 * 1024 * 1024);
+
+    /* Allocate stuff */
+    data.scalars = malloc(sizeof(secp256k1_scalar) * POINTS);
+    data.pubkeys = malloc(sizeof(secp256k1_ge) * POINTS);
+    data.output = malloc(sizeof(secp256k1_gej) * ITERS);
+
+    /* Generate a set of scalars and points from a fixed seed */
+    secp256k1_scalar_set_int(&g_sc, 1);
+    for (i = 0; i < POINTS; ++i) {
+        unsigned char buf[32] = {0};
+        int overflow;
+        buf[0] = 0x41;
+        buf[28] = (i >> 24) & 0xff;
+        buf[29] = (i >> 16) & 0xff;
+        buf[30] = (i >> 8) & 0xff;
+        buf[31] = i & 0xff;
+        secp256k1_scalar_set_b32(&data.scalars[i], buf, &overflow);
+        secp256k1_scalar_mul(&data.scalars[i], &data.scalars[i], &data.scalars[i]);
+        secp256k1_scalar_add(&g_sc, &g_sc, &data.scalars[i]);
+        secp256k1_ecmult_gen(&data.ctx->ecmult_gen_ctx, &gej, &g_sc);
+        secp256k1_ge_set_gej_var(&data.pubkeys[i], &gej);
+    }
+
+    for (i = 1; i <= 8; ++i) {
+        run_test(&data, i, 1);
+    }
+    for (p = 0; p <= 10; ++p) {
+        run_test(&data, 1 << p, 1);
+        if (p > 2 && (1 << p) + 3 <= POINTS) {
+            run_test(&data, (1 << p) + 3, 0);
+        }
+    }
+
+    secp256k1_context_destroy(data.ctx);
+    secp256k1_scratch_space_destroy(data.scratch);
+    free(data.scalars);
+    free(data.pubkeys);
+    free(data.output);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**********************************************************************
+ * Copyright (c) 2026 The Globe developers                            *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "include/secp256k1.h"
+#include "include/secp256k1_rangeproof.h"
+#include "util.h"
+#include "bench.h"
+
+#define COMMITS 1000
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_pedersen_commitment commit;
+    unsigned char proof[5134];
+    unsigned char blind[32];
+    size_t len;
+    uint64_t v;
+} bench_rangeproof_t;
+
+static void bench_rangeproof_setup(void* arg) {
+    bench_rangeproof_t *data = (bench_rangeproof_t*)arg;
+    int i;
+
+    data->v = 123456;
+    for (i = 0; i < 32; i++) {
+        data->blind[i] = i + 1;
+    }
+    CHECK(secp256k1_pedersen_commit(data->ctx, &data->commit, data->blind, data->v, secp256k1_generator_h));
+    data->len = sizeof(data->proof);
+    CHECK(secp256k1_rangeproof_sign(data->ctx, data->proof, &data->len, 0, &data->commit, data->blind, data->commit.data, 0, 0, data->v, NULL, 0, NULL, 0, secp256k1_generator_h));
+}
+
+static void bench_pedersen_commit(void* arg) {
+    bench_rangeproof_t *data = (bench_rangeproof_t*)arg;
+    int i;
+
+    for (i = 0; i < COMMITS; i++) {
+        CHECK(secp256k1_pedersen_commit(data->ctx, &data->commit, data->blind, data->v + i, secp256k1_generator_h));
+    }
+}
+
+static void bench_rangeproof_sign(void* arg) {
+    bench_rangeproof_t *data = (bench_rangeproof_t*)arg;
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        data->len = sizeof(data->proof);
+        CHECK(secp256k1_rangeproof_sign(data->ctx, data->proof, &data->len, 0, &data->commit, data->blind, data->commit.data, 0, 0, data->v, NULL, 0, NULL, 0, secp256k1_generator_h));
+    }
+}
+
+static void bench_rangeproof_verify(void* arg) {
+    bench_rangeproof_t *data = (bench_rangeproof_t*)arg;
+    uint64_t minv;
+    uint64_t maxv;
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        CHECK(secp256k1_rangeproof_verify(data->ctx, &minv, &maxv, &data->commit, data->proof, data->len, NULL, 0, secp256k1_generator_h));
+    }
+}
+
+int main(void) {
+    bench_rangeproof_t data;
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+
+    run_benchmark("pedersen_commit", bench_pedersen_commit, bench_rangeproof_setup, NULL, &data, 10, COMMITS);
+    run_benchmark("rangeproof_sign", bench_rangeproof_sign, bench_rangeproof_setup, NULL, &data, 10, 10);
+    run_benchmark("rangeproof_verify", bench_rangeproof_verify, bench_rangeproof_setup, NULL, &data, 10, 100);
+
+    secp256k1_pedersen_context_initialize(data.ctx);
+
+    run_benchmark("pedersen_commit_precomputed", bench_pedersen_commit, bench_rangeproof_setup, NULL, &data, 10, COMMITS);
+    run_benchmark("rangeproof_sign_precomputed", bench_rangeproof_sign, bench_rangeproof_setup, NULL, &data, 10, 10);
+    run_benchmark("rangeproof_verify_precomputed", bench_rangeproof_verify, bench_rangeproof_setup, NULL, &data, 10, 100);
+
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
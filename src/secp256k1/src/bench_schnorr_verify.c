@@ -0,0 +1,80 @@
+/**********************************************************************
+ * Copyright (c) 2018 The Particl Core developers                     *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "include/secp256k1.h"
+#include "include/secp256k1_schnorr.h"
+#include "util.h"
+#include "bench.h"
+
+#define MAX_SIGS 4096
+
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_scratch_space *scratch;
+    unsigned char msg[MAX_SIGS][32];
+    unsigned char sig[MAX_SIGS][64];
+    secp256k1_pubkey pubkey[MAX_SIGS];
+    const unsigned char *sigptr[MAX_SIGS];
+    const unsigned char *msgptr[MAX_SIGS];
+    const secp256k1_pubkey *pkptr[MAX_SIGS];
+    size_t n;
+} benchmark_schnorr_verify_t;
+
+static void benchmark_schnorr_verify(void* arg) {
+    size_t i;
+    benchmark_schnorr_verify_t* data = (benchmark_schnorr_verify_t*)arg;
+
+    for (i = 0; i < MAX_SIGS; i++) {
+        CHECK(secp256k1_schnorr_verify(data->ctx, data->sig[i], data->msg[i], &data->pubkey[i]) == 1);
+    }
+}
+
+static void benchmark_schnorr_verify_batch(void* arg) {
+    size_t i;
+    benchmark_schnorr_verify_t* data = (benchmark_schnorr_verify_t*)arg;
+
+    for (i = 0; i + data->n <= MAX_SIGS; i += data->n) {
+        CHECK(secp256k1_schnorr_verify_batch(data->ctx, data->scratch, &data->sigptr[i], &data->msgptr[i], &data->pkptr[i], data->n) == 1);
+    }
+}
+
+int main(void) {
+    static benchmark_schnorr_verify_t data;
+    char name[64];
+    size_t i, n;
+
+    data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 8 * 1024 * 1024);
+
+    for (i = 0; i < MAX_SIGS; i++) {
+        unsigned char key[32];
+        memset(key, 0, 32);
+        key[0] = 1 + (i & 0xff);
+        key[1] = 1 + (i >> 8);
+        memset(data.msg[i], 0, 32);
+        data.msg[i][0] = i & 0xff;
+        data.msg[i][1] = i >> 8;
+        CHECK(secp256k1_ec_pubkey_create(data.ctx, &data.pubkey[i], key));
+        CHECK(secp256k1_schnorr_sign(data.ctx, data.sig[i], data.msg[i], key, NULL, NULL));
+        data.sigptr[i] = data.sig[i];
+        data.msgptr[i] = data.msg[i];
+        data.pkptr[i] = &data.pubkey[i];
+    }
+
+    run_benchmark("schnorr_verify", benchmark_schnorr_verify, NULL, NULL, &data, 5, MAX_SIGS);
+    for (n = 1; n <= MAX_SIGS; n *= 4) {
+        data.n = n;
+        sprintf(name, "schnorr_verify_batch_%d", (int)n);
+        run_benchmark(name, benchmark_schnorr_verify_batch, NULL, NULL, &data, 5, MAX_SIGS);
+    }
+
+    secp256k1_scratch_space_destroy(data.scratch);
+    secp256k1_context_destroy(data.ctx);
+    return 0;
+}
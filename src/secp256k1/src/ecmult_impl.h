@@ -12,6 +12,7 @@
 #include "group.h"
 #include "scalar.h"
 #include "ecmult.h"
+#include "scratch_impl.h"
 
 #include <string.h>
 
@@ -405,4 +406,426 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej
     }
 }
 
+/** Below this number of points Strauss is faster than Pippenger */
+#define ECMULT_PIPPENGER_THRESHOLD 88
+
+#define PIPPENGER_MAX_WINDOW 12
+
+#ifdef USE_ENDOMORPHISM
+    #define ECMULT_MULTI_SCALAR_BITS 130
+    #define ECMULT_MULTI_TERMS 2
+#else
+    #define ECMULT_MULTI_SCALAR_BITS 256
+    #define ECMULT_MULTI_TERMS 1
+#endif
+
+/** Strauss state of one point: the wNAF of its scalar (or of both halves of
+ *  the split scalar) */
+struct secp256k1_strauss_point_state {
+#ifdef USE_ENDOMORPHISM
+    int wnaf_na_1[130];
+    int wnaf_na_lam[130];
+    int bits_na_1;
+    int bits_na_lam;
+#else
+    int wnaf_na[256];
+    int bits_na;
+#endif
+};
+
+static size_t secp256k1_strauss_scratch_size(size_t n_points) {
+#ifdef USE_ENDOMORPHISM
+    static const size_t point_size = (2 * sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) * ECMULT_TABLE_SIZE(WINDOW_A) + sizeof(struct secp256k1_strauss_point_state) + sizeof(secp256k1_gej) + sizeof(secp256k1_scalar);
+#else
+    static const size_t point_size = (sizeof(secp256k1_ge) + sizeof(secp256k1_gej) + sizeof(secp256k1_fe)) * ECMULT_TABLE_SIZE(WINDOW_A) + sizeof(struct secp256k1_strauss_point_state) + sizeof(secp256k1_gej) + sizeof(secp256k1_scalar);
+#endif
+    return n_points * point_size;
+}
+
+/* Number of allocations secp256k1_ecmult_strauss_batch makes from its frame */
+#define STRAUSS_SCRATCH_OBJECTS 7
+
+static size_t secp256k1_strauss_max_points(const secp256k1_scratch *scratch) {
+    return secp256k1_scratch_max_allocation(scratch, STRAUSS_SCRATCH_OBJECTS) / secp256k1_strauss_scratch_size(1);
+}
+
+/** Strauss' algorithm on n_points terms starting at cb_offset: one chain of
+ *  doublings, the odd multiples of every point brought to a single global Z
+ *  as in secp256k1_ecmult, and the precomputed G tables for inp_g_sc. */
+static int secp256k1_ecmult_strauss_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    secp256k1_gej *points;
+    secp256k1_scalar *scalars;
+    secp256k1_gej *prej;
+    secp256k1_fe *zr;
+    secp256k1_ge *pre_a;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge *pre_a_lam;
+    secp256k1_scalar ng_1, ng_128;
+    int wnaf_ng_1[129];
+    int bits_ng_1 = 0;
+    int wnaf_ng_128[129];
+    int bits_ng_128 = 0;
+#else
+    int wnaf_ng[256];
+    int bits_ng = 0;
+#endif
+    struct secp256k1_strauss_point_state *ps;
+    secp256k1_ge tmpa;
+    secp256k1_fe Z;
+    size_t np, no = 0;
+    int i;
+    int bits = 0;
+
+    secp256k1_gej_set_infinity(r);
+    if (inp_g_sc == NULL && n_points == 0) {
+        return 1;
+    }
+
+    if (!secp256k1_scratch_allocate_frame(scratch, secp256k1_strauss_scratch_size(n_points), STRAUSS_SCRATCH_OBJECTS)) {
+        return 0;
+    }
+    points = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, n_points * sizeof(secp256k1_gej));
+    scalars = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, n_points * sizeof(secp256k1_scalar));
+    prej = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, n_points * ECMULT_TABLE_SIZE(WINDOW_A) * sizeof(secp256k1_gej));
+    zr = (secp256k1_fe*)secp256k1_scratch_alloc(scratch, n_points * ECMULT_TABLE_SIZE(WINDOW_A) * sizeof(secp256k1_fe));
+    pre_a = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, n_points * ECMULT_TABLE_SIZE(WINDOW_A) * sizeof(secp256k1_ge));
+#ifdef USE_ENDOMORPHISM
+    pre_a_lam = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, n_points * ECMULT_TABLE_SIZE(WINDOW_A) * sizeof(secp256k1_ge));
+#endif
+    ps = (struct secp256k1_strauss_point_state*)secp256k1_scratch_alloc(scratch, n_points * sizeof(struct secp256k1_strauss_point_state));
+
+    for (np = 0; np < n_points; np++) {
+        secp256k1_ge point;
+        if (!cb(&scalars[no], &point, np + cb_offset, cbdata)) {
+            secp256k1_scratch_deallocate_frame(scratch);
+            return 0;
+        }
+        if (secp256k1_scalar_is_zero(&scalars[no]) || secp256k1_ge_is_infinity(&point)) {
+            continue;
+        }
+        secp256k1_gej_set_ge(&points[no], &point);
+#ifdef USE_ENDOMORPHISM
+        {
+            secp256k1_scalar na_1, na_lam;
+            /* split na into na_1 and na_lam (where na = na_1 + na_lam*lambda, and na_1 and na_lam are ~128 bit) */
+            secp256k1_scalar_split_lambda(&na_1, &na_lam, &scalars[no]);
+            ps[no].bits_na_1   = secp256k1_ecmult_wnaf(ps[no].wnaf_na_1,   130, &na_1,   WINDOW_A);
+            ps[no].bits_na_lam = secp256k1_ecmult_wnaf(ps[no].wnaf_na_lam, 130, &na_lam, WINDOW_A);
+            if (ps[no].bits_na_1 > bits) {
+                bits = ps[no].bits_na_1;
+            }
+            if (ps[no].bits_na_lam > bits) {
+                bits = ps[no].bits_na_lam;
+            }
+        }
+#else
+        ps[no].bits_na = secp256k1_ecmult_wnaf(ps[no].wnaf_na, 256, &scalars[no], WINDOW_A);
+        if (ps[no].bits_na > bits) {
+            bits = ps[no].bits_na;
+        }
+#endif
+        no++;
+    }
+
+    /* Calculate the odd multiples of every point. Each table starts from its
+     * point rescaled by the last Z of the previous table, which chains the Z
+     * ratios so all of them can be brought to one global Z denominator. */
+    if (no > 0) {
+        secp256k1_ecmult_odd_multiples_table(ECMULT_TABLE_SIZE(WINDOW_A), prej, zr, &points[0]);
+        for (np = 1; np < no; ++np) {
+            secp256k1_gej tmp = points[np];
+#ifdef VERIFY
+            secp256k1_fe_normalize_var(&prej[(np - 1) * ECMULT_TABLE_SIZE(WINDOW_A) + ECMULT_TABLE_SIZE(WINDOW_A) - 1].z);
+#endif
+            secp256k1_gej_rescale(&tmp, &prej[(np - 1) * ECMULT_TABLE_SIZE(WINDOW_A) + ECMULT_TABLE_SIZE(WINDOW_A) - 1].z);
+            secp256k1_ecmult_odd_multiples_table(ECMULT_TABLE_SIZE(WINDOW_A), prej + np * ECMULT_TABLE_SIZE(WINDOW_A), zr + np * ECMULT_TABLE_SIZE(WINDOW_A), &tmp);
+            secp256k1_fe_mul(zr + np * ECMULT_TABLE_SIZE(WINDOW_A), zr + np * ECMULT_TABLE_SIZE(WINDOW_A), &points[np].z);
+        }
+        secp256k1_ge_globalz_set_table_gej(ECMULT_TABLE_SIZE(WINDOW_A) * no, pre_a, &Z, prej, zr);
+    } else {
+        secp256k1_fe_set_int(&Z, 1);
+    }
+
+#ifdef USE_ENDOMORPHISM
+    for (np = 0; np < no * ECMULT_TABLE_SIZE(WINDOW_A); np++) {
+        secp256k1_ge_mul_lambda(&pre_a_lam[np], &pre_a[np]);
+    }
+
+    if (inp_g_sc) {
+        /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
+        secp256k1_scalar_split_128(&ng_1, &ng_128, inp_g_sc);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
+        if (bits_ng_1 > bits) {
+            bits = bits_ng_1;
+        }
+        if (bits_ng_128 > bits) {
+            bits = bits_ng_128;
+        }
+    }
+#else
+    if (inp_g_sc) {
+        bits_ng = secp256k1_ecmult_wnaf(wnaf_ng, 256, inp_g_sc, WINDOW_G);
+        if (bits_ng > bits) {
+            bits = bits_ng;
+        }
+    }
+#endif
+
+    for (i = bits - 1; i >= 0; i--) {
+        int n;
+        secp256k1_gej_double_var(r, r, NULL);
+#ifdef USE_ENDOMORPHISM
+        for (np = 0; np < no; ++np) {
+            if (i < ps[np].bits_na_1 && (n = ps[np].wnaf_na_1[i])) {
+                ECMULT_TABLE_GET_GE(&tmpa, pre_a + np * ECMULT_TABLE_SIZE(WINDOW_A), n, WINDOW_A);
+                secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+            }
+            if (i < ps[np].bits_na_lam && (n = ps[np].wnaf_na_lam[i])) {
+                ECMULT_TABLE_GET_GE(&tmpa, pre_a_lam + np * ECMULT_TABLE_SIZE(WINDOW_A), n, WINDOW_A);
+                secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+            }
+        }
+        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+#else
+        for (np = 0; np < no; ++np) {
+            if (i < ps[np].bits_na && (n = ps[np].wnaf_na[i])) {
+                ECMULT_TABLE_GET_GE(&tmpa, pre_a + np * ECMULT_TABLE_SIZE(WINDOW_A), n, WINDOW_A);
+                secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+            }
+        }
+        if (i < bits_ng && (n = wnaf_ng[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+#endif
+    }
+
+    if (!r->infinity) {
+        secp256k1_fe_mul(&r->z, &r->z, &Z);
+    }
+
+    secp256k1_scratch_deallocate_frame(scratch);
+    return 1;
+}
+
+/** Pippenger's bucket method. Every scalar is cut into windows of w bits;
+ *  for each window from the top, points are added to the bucket of their
+ *  digit and the buckets are summed weighted by digit with two running sums. */
+static int secp256k1_pippenger_bucket_window(size_t n_points) {
+    /* Minimise windows * (n_points + 2 * buckets) additions */
+    size_t best_cost = 0;
+    int w, best_w = 1;
+    for (w = 1; w <= PIPPENGER_MAX_WINDOW; w++) {
+        size_t windows = (ECMULT_MULTI_SCALAR_BITS + w - 1) / w;
+        size_t cost = windows * (n_points * ECMULT_MULTI_TERMS + 2 * ((size_t)1 << w));
+        if (w == 1 || cost < best_cost) {
+            best_cost = cost;
+            best_w = w;
+        }
+    }
+    return best_w;
+}
+
+static size_t secp256k1_pippenger_scratch_size(size_t n_points, int bucket_window) {
+    size_t entries = (n_points + 1) * ECMULT_MULTI_TERMS; /* + 1 for G */
+    return entries * (sizeof(secp256k1_ge) + sizeof(secp256k1_scalar)) + ((size_t)1 << bucket_window) * sizeof(secp256k1_gej);
+}
+
+/* Number of allocations secp256k1_ecmult_pippenger_batch makes from its frame */
+#define PIPPENGER_SCRATCH_OBJECTS 3
+
+static size_t secp256k1_pippenger_max_points(const secp256k1_scratch *scratch) {
+    size_t max_alloc = secp256k1_scratch_max_allocation(scratch, PIPPENGER_SCRATCH_OBJECTS);
+    size_t res = 0;
+    int w;
+    for (w = 1; w <= PIPPENGER_MAX_WINDOW; w++) {
+        size_t bucket_bytes = ((size_t)1 << w) * sizeof(secp256k1_gej);
+        size_t entry_bytes = ECMULT_MULTI_TERMS * (sizeof(secp256k1_ge) + sizeof(secp256k1_scalar));
+        size_t n;
+        if (max_alloc < bucket_bytes + entry_bytes * 2) {
+            break;
+        }
+        n = (max_alloc - bucket_bytes) / entry_bytes - 1;
+        /* Only count sizes for which this window would be chosen */
+        if (secp256k1_pippenger_bucket_window(n) <= w && n > res) {
+            res = n;
+        }
+    }
+    return res;
+}
+
+static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    secp256k1_ge *points;
+    secp256k1_scalar *scalars;
+    secp256k1_gej *buckets;
+    secp256k1_gej running_sum, window_sum;
+    size_t np, no = 0;
+    int bucket_window = secp256k1_pippenger_bucket_window(n_points);
+    int n_buckets = (1 << bucket_window) - 1;
+    int bits, window, b;
+    (void)ctx;
+
+    secp256k1_gej_set_infinity(r);
+    if (inp_g_sc == NULL && n_points == 0) {
+        return 1;
+    }
+
+    if (!secp256k1_scratch_allocate_frame(scratch, secp256k1_pippenger_scratch_size(n_points, bucket_window), PIPPENGER_SCRATCH_OBJECTS)) {
+        return 0;
+    }
+    points = (secp256k1_ge*)secp256k1_scratch_alloc(scratch, (n_points + 1) * ECMULT_MULTI_TERMS * sizeof(secp256k1_ge));
+    scalars = (secp256k1_scalar*)secp256k1_scratch_alloc(scratch, (n_points + 1) * ECMULT_MULTI_TERMS * sizeof(secp256k1_scalar));
+    buckets = (secp256k1_gej*)secp256k1_scratch_alloc(scratch, ((size_t)1 << bucket_window) * sizeof(secp256k1_gej));
+
+    if (inp_g_sc != NULL && !secp256k1_scalar_is_zero(inp_g_sc)) {
+        scalars[no] = *inp_g_sc;
+        points[no] = secp256k1_ge_const_g;
+        no++;
+    }
+    for (np = 0; np < n_points; np++) {
+        if (!cb(&scalars[no], &points[no], np + cb_offset, cbdata)) {
+            secp256k1_scratch_deallocate_frame(scratch);
+            return 0;
+        }
+        if (secp256k1_scalar_is_zero(&scalars[no]) || secp256k1_ge_is_infinity(&points[no])) {
+            continue;
+        }
+        no++;
+    }
+
+#ifdef USE_ENDOMORPHISM
+    /* Split every scalar into two ~128 bit halves, the second applying to
+     * lambda times the point. Negative halves are negated along with their
+     * point so every digit is positive. */
+    for (np = no; np-- > 0;) {
+        secp256k1_scalar s = scalars[np];
+        secp256k1_ge p = points[np];
+        secp256k1_scalar_split_lambda(&scalars[2 * np], &scalars[2 * np + 1], &s);
+        points[2 * np] = p;
+        secp256k1_ge_mul_lambda(&points[2 * np + 1], &p);
+    }
+    no *= 2;
+    for (np = 0; np < no; np++) {
+        if (secp256k1_scalar_is_high(&scalars[np])) {
+            secp256k1_scalar_negate(&scalars[np], &scalars[np]);
+            secp256k1_ge_neg(&points[np], &points[np]);
+        }
+    }
+#endif
+
+    bits = ECMULT_MULTI_SCALAR_BITS;
+    for (window = (bits + bucket_window - 1) / bucket_window - 1; window >= 0; window--) {
+        int offset = window * bucket_window;
+        int width = bits - offset < bucket_window ? bits - offset : bucket_window;
+        int k;
+
+        for (k = 0; k < bucket_window; k++) {
+            secp256k1_gej_double_var(r, r, NULL);
+        }
+        for (b = 0; b < n_buckets; b++) {
+            secp256k1_gej_set_infinity(&buckets[b]);
+        }
+        for (np = 0; np < no; np++) {
+            unsigned int digit = secp256k1_scalar_get_bits_var(&scalars[np], offset, width);
+            if (digit != 0) {
+                secp256k1_gej_add_ge_var(&buckets[digit - 1], &buckets[digit - 1], &points[np], NULL);
+            }
+        }
+        /* window_sum = sum_b (b + 1) * buckets[b] */
+        secp256k1_gej_set_infinity(&running_sum);
+        secp256k1_gej_set_infinity(&window_sum);
+        for (b = n_buckets - 1; b >= 0; b--) {
+            secp256k1_gej_add_var(&running_sum, &running_sum, &buckets[b], NULL);
+            secp256k1_gej_add_var(&window_sum, &window_sum, &running_sum, NULL);
+        }
+        secp256k1_gej_add_var(r, r, &window_sum, NULL);
+    }
+
+    secp256k1_scratch_deallocate_frame(scratch);
+    return 1;
+}
+
+/** Without a usable scratch space: one secp256k1_ecmult per point */
+static int secp256k1_ecmult_multi_simple_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points) {
+    secp256k1_scalar szero;
+    size_t point_idx;
+
+    secp256k1_scalar_set_int(&szero, 0);
+    secp256k1_gej_set_infinity(r);
+    if (inp_g_sc != NULL) {
+        /* secp256k1_ecmult needs a finite point, pass G with a zero scalar */
+        secp256k1_gej gj;
+        secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
+        secp256k1_ecmult(ctx, r, &gj, &szero, inp_g_sc);
+    }
+    for (point_idx = 0; point_idx < n_points; point_idx++) {
+        secp256k1_ge point;
+        secp256k1_gej pointj;
+        secp256k1_scalar scalar;
+        if (!cb(&scalar, &point, point_idx, cbdata)) {
+            return 0;
+        }
+        if (secp256k1_scalar_is_zero(&scalar) || secp256k1_ge_is_infinity(&point)) {
+            continue;
+        }
+        secp256k1_gej_set_ge(&pointj, &point);
+        secp256k1_ecmult(ctx, &pointj, &pointj, &scalar, &szero);
+        secp256k1_gej_add_var(r, r, &pointj, NULL);
+    }
+    return 1;
+}
+
+typedef int (*secp256k1_ecmult_multi_func)(const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+
+static int secp256k1_ecmult_multi_var(const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    size_t i;
+    size_t max_points;
+    size_t n_batches;
+    size_t n_batch_points;
+    secp256k1_ecmult_multi_func f;
+
+    secp256k1_gej_set_infinity(r);
+    if (inp_g_sc == NULL && n == 0) {
+        return 1;
+    }
+    if (scratch == NULL) {
+        return secp256k1_ecmult_multi_simple_var(ctx, r, inp_g_sc, cb, cbdata, n);
+    }
+
+    if (n >= ECMULT_PIPPENGER_THRESHOLD) {
+        f = secp256k1_ecmult_pippenger_batch;
+        max_points = secp256k1_pippenger_max_points(scratch);
+    } else {
+        f = secp256k1_ecmult_strauss_batch;
+        max_points = secp256k1_strauss_max_points(scratch);
+    }
+    if (max_points == 0) {
+        return secp256k1_ecmult_multi_simple_var(ctx, r, inp_g_sc, cb, cbdata, n);
+    }
+    if (n == 0) {
+        return f(ctx, scratch, r, inp_g_sc, cb, cbdata, 0, 0);
+    }
+
+    /* Spread the points evenly over the fewest batches that fit */
+    n_batches = (n + max_points - 1) / max_points;
+    n_batch_points = (n + n_batches - 1) / n_batches;
+    for (i = 0; i < n_batches; i++) {
+        size_t nbp = n - i * n_batch_points < n_batch_points ? n - i * n_batch_points : n_batch_points;
+        secp256k1_gej tmp;
+        if (!f(ctx, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cbdata, nbp, i * n_batch_points)) {
+            return 0;
+        }
+        secp256k1_gej_add_var(r, r, &tmp, NULL);
+    }
+    return 1;
+}
+
 #endif /* SECP256K1_ECMULT_IMPL_H */
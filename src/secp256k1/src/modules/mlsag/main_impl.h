@@ -154,9 +154,9 @@ static int hash_to_curve(secp256k1_ge *ge, const uint8_t *pd, size_t len)
 
     for (k = 0; k < safety; ++k)
     {
+        /* secp256k1_ge_set_xo_var only succeeds if x^3 + 7 has a square root, which makes the point valid */
         if (secp256k1_fe_set_b32(&x, hash)
-            && secp256k1_ge_set_xo_var(ge, &x, 0)
-            && secp256k1_ge_is_valid_var(ge)) /* Is secp256k1_ge_is_valid_var necessary? */
+            && secp256k1_ge_set_xo_var(ge, &x, 0))
             break;
 
         secp256k1_sha256_initialize(&sha256_m);
@@ -170,6 +170,50 @@ static int hash_to_curve(secp256k1_ge *ge, const uint8_t *pd, size_t len)
     return 0;
 }
 
+int secp256k1_get_mlsag_points(uint8_t *out, const uint8_t *pk)
+{
+    secp256k1_ge ge1;
+
+    if (!secp256k1_eckey_pubkey_parse(&ge1, pk, 33))
+        return 1;
+    secp256k1_fe_normalize_var(&ge1.x);
+    secp256k1_fe_normalize_var(&ge1.y);
+    secp256k1_fe_get_b32(&out[0], &ge1.x);
+    secp256k1_fe_get_b32(&out[32], &ge1.y);
+
+    if (0 != hash_to_curve(&ge1, pk, 33)) /* H(pk) */
+        return 2;
+    secp256k1_fe_normalize_var(&ge1.x);
+    secp256k1_fe_normalize_var(&ge1.y);
+    secp256k1_fe_get_b32(&out[64], &ge1.x);
+    secp256k1_fe_get_b32(&out[96], &ge1.y);
+
+    return 0;
+}
+
+/** Load a point stored as x || y, checking it is on the curve */
+static int mlsag_load_xy(secp256k1_ge *ge, const uint8_t *xy)
+{
+    secp256k1_fe x, y;
+
+    if (!secp256k1_fe_set_b32(&x, &xy[0])
+        || !secp256k1_fe_set_b32(&y, &xy[32]))
+        return 0;
+    secp256k1_ge_set_xy(ge, &x, &y);
+    return secp256k1_ge_is_valid_var(ge);
+}
+
+/** Load the points written by secp256k1_get_mlsag_points, the pubkey must match its compressed form pk */
+static int mlsag_load_points(secp256k1_ge *gpk, secp256k1_ge *gh, const uint8_t *pkh, const uint8_t *pk)
+{
+    if (!mlsag_load_xy(gpk, &pkh[0])
+        || !mlsag_load_xy(gh, &pkh[64]))
+        return 0;
+
+    return pk[0] == (secp256k1_fe_is_odd(&gpk->y) ? SECP256K1_TAG_PUBKEY_ODD : SECP256K1_TAG_PUBKEY_EVEN)
+        && memcmp(&pk[1], &pkh[0], 32) == 0;
+}
+
 int secp256k1_get_keyimage(const secp256k1_context *ctx, uint8_t *ki, const uint8_t *pk, const uint8_t *sk)
 {
     secp256k1_ge ge1;
@@ -394,97 +438,303 @@ int secp256k1_generate_mlsag(const secp256k1_context *ctx,
     return 0;
 }
 
-int secp256k1_verify_mlsag(const secp256k1_context *ctx,
-    const uint8_t *preimage, size_t nCols, size_t nRows,
-    const uint8_t *pk, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps)
+/* The key image tables are built once per row and reused for every column,
+ * so they can afford a wider window than the per cell H(pk) tables. */
+#define MLSAG_WINDOW_KI 6
+
+/** Odd multiples [1*ki,3*ki,...] of a key image in affine coordinates */
+typedef struct {
+    secp256k1_ge pre[ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI)];
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge pre_lam[ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI)];
+#endif
+} mlsag_ki_table;
+
+static void mlsag_ki_table_build(mlsag_ki_table *t, const secp256k1_ge *ki)
 {
-    secp256k1_sha256_t sha256_m, sha256_pre;
-    secp256k1_scalar zero, clast, cSig, ss;
-    secp256k1_ge ge1;
-    secp256k1_gej gej1, gej2, L, R;
-    size_t dsRows = nRows-1; /* TODO: pass in dsRows explicitly? */
-    uint8_t tmp[33];
-    size_t i, k, clen;
-    int overflow;
+    secp256k1_gej prej[ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI)];
+    secp256k1_fe zr[ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI)];
+    secp256k1_gej kij;
+#ifdef USE_ENDOMORPHISM
+    int i;
+#endif
+
+    secp256k1_gej_set_ge(&kij, ki);
+    secp256k1_ecmult_odd_multiples_table(ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI), prej, zr, &kij);
+    secp256k1_ge_set_table_gej_var(t->pre, prej, zr, ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI));
+#ifdef USE_ENDOMORPHISM
+    for (i = 0; i < ECMULT_TABLE_SIZE(MLSAG_WINDOW_KI); i++) {
+        secp256k1_ge_mul_lambda(&t->pre_lam[i], &t->pre[i]);
+    }
+#endif
+}
 
-    secp256k1_scalar_set_int(&zero, 0);
+/** r = na * a + nb * ki, a two point Strauss multiplication sharing one chain
+ *  of doublings. As in secp256k1_ecmult the table of a is kept on a global Z
+ *  and the affine key image table is added with the inverse of that Z.
+ */
+static void mlsag_ecmult_2(secp256k1_gej *r, const secp256k1_ge *a, const secp256k1_scalar *na,
+    const mlsag_ki_table *tki, const secp256k1_scalar *nb)
+{
+    secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_ge tmpa;
+    secp256k1_gej aj;
+    secp256k1_fe Z;
+#ifdef USE_ENDOMORPHISM
+    secp256k1_ge pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_scalar na_1, na_lam, nb_1, nb_lam;
+    int wnaf_na_1[130];
+    int wnaf_na_lam[130];
+    int wnaf_nb_1[130];
+    int wnaf_nb_lam[130];
+    int bits_na_1, bits_na_lam, bits_nb_1, bits_nb_lam;
+#else
+    int wnaf_na[256];
+    int wnaf_nb[256];
+    int bits_na, bits_nb;
+#endif
+    int i;
+    int bits;
+
+#ifdef USE_ENDOMORPHISM
+    secp256k1_scalar_split_lambda(&na_1, &na_lam, na);
+    secp256k1_scalar_split_lambda(&nb_1, &nb_lam, nb);
+    bits_na_1   = secp256k1_ecmult_wnaf(wnaf_na_1,   130, &na_1,   WINDOW_A);
+    bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, 130, &na_lam, WINDOW_A);
+    bits_nb_1   = secp256k1_ecmult_wnaf(wnaf_nb_1,   130, &nb_1,   MLSAG_WINDOW_KI);
+    bits_nb_lam = secp256k1_ecmult_wnaf(wnaf_nb_lam, 130, &nb_lam, MLSAG_WINDOW_KI);
+    bits = bits_na_1;
+    if (bits_na_lam > bits) {
+        bits = bits_na_lam;
+    }
+    if (bits_nb_1 > bits) {
+        bits = bits_nb_1;
+    }
+    if (bits_nb_lam > bits) {
+        bits = bits_nb_lam;
+    }
+#else
+    bits_na = secp256k1_ecmult_wnaf(wnaf_na, 256, na, WINDOW_A);
+    bits_nb = secp256k1_ecmult_wnaf(wnaf_nb, 256, nb, MLSAG_WINDOW_KI);
+    bits = bits_na > bits_nb ? bits_na : bits_nb;
+#endif
+
+    secp256k1_gej_set_ge(&aj, a);
+    secp256k1_ecmult_odd_multiples_table_globalz_windowa(pre_a, &Z, &aj);
+#ifdef USE_ENDOMORPHISM
+    for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
+        secp256k1_ge_mul_lambda(&pre_a_lam[i], &pre_a[i]);
+    }
+#endif
+
+    secp256k1_gej_set_infinity(r);
+
+    for (i = bits - 1; i >= 0; i--) {
+        int n;
+        secp256k1_gej_double_var(r, r, NULL);
+#ifdef USE_ENDOMORPHISM
+        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, pre_a_lam, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_nb_1 && (n = wnaf_nb_1[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, tki->pre, n, MLSAG_WINDOW_KI);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+        if (i < bits_nb_lam && (n = wnaf_nb_lam[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, tki->pre_lam, n, MLSAG_WINDOW_KI);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+#else
+        if (i < bits_na && (n = wnaf_na[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_nb && (n = wnaf_nb[i])) {
+            ECMULT_TABLE_GET_GE(&tmpa, tki->pre, n, MLSAG_WINDOW_KI);
+            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        }
+#endif
+    }
 
-    secp256k1_scalar_set_b32(&clast, pc, &overflow);
-    if (overflow || secp256k1_scalar_is_zero(&clast))
-        return 1;
+    if (!r->infinity) {
+        secp256k1_fe_mul(&r->z, &r->z, &Z);
+    }
+}
 
-    cSig = clast;
+/** secp256k1_ge_set_all_gej_var with caller provided scratch space */
+static void mlsag_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len, secp256k1_fe *az, secp256k1_fe *azi)
+{
+    size_t i;
+    size_t count = 0;
 
-    secp256k1_sha256_initialize(&sha256_m);
-    secp256k1_sha256_write(&sha256_m, preimage, 32);
-    sha256_pre = sha256_m;
+    for (i = 0; i < len; i++) {
+        if (!a[i].infinity) {
+            az[count++] = a[i].z;
+        }
+    }
+    secp256k1_fe_inv_all_var(azi, az, count);
+
+    count = 0;
+    for (i = 0; i < len; i++) {
+        r[i].infinity = a[i].infinity;
+        if (!a[i].infinity) {
+            secp256k1_ge_set_gej_zinv(&r[i], &a[i], &azi[count++]);
+        }
+    }
+}
+
+/** Run the ring of columns, leaving the final challenge in clast.
+ *  pkh, if not NULL, holds the points of secp256k1_get_mlsag_points for
+ *  every cell of the dsRows rows.
+ *  lrj/lr hold the L point of every row followed by the R point of the
+ *  dsRows rows, az/azi are scratch for their batched inversion.
+ */
+static int mlsag_verify_columns(const secp256k1_context *ctx, secp256k1_scalar *clast,
+    const secp256k1_sha256_t *sha256_pre, size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *pkh, const uint8_t *ki, const uint8_t *ps,
+    mlsag_ki_table *tki, secp256k1_gej *lrj, secp256k1_ge *lr, secp256k1_fe *az, secp256k1_fe *azi)
+{
+    secp256k1_sha256_t sha256_m;
+    secp256k1_scalar ss;
+    secp256k1_ge ge1, gh;
+    secp256k1_gej gej1;
+    size_t dsRows = nRows-1;
+    uint8_t tmp[33];
+    size_t i, k, clen;
+    int overflow;
+
+    for (k = 0; k < dsRows; ++k)
+    {
+        if (!secp256k1_eckey_pubkey_parse(&ge1, &ki[k * 33], 33))
+            return 1;
+        mlsag_ki_table_build(&tki[k], &ge1);
+    };
 
     for (i = 0; i < nCols; ++i)
     {
-        sha256_m = sha256_pre; /* set to after preimage hashed */
+        sha256_m = *sha256_pre; /* set to after preimage hashed */
 
-        for (k = 0; k < dsRows; ++k)
+        for (k = 0; k < nRows; ++k)
         {
             /* L = G * ss + pk[k][i] * clast */
             secp256k1_scalar_set_b32(&ss, &ps[(i + k*nCols)*32], &overflow);
             if (overflow || secp256k1_scalar_is_zero(&ss))
                 return 1;
-            if (!secp256k1_eckey_pubkey_parse(&ge1, &pk[(i + k*nCols)*33], 33))
-                return 1;
+            if (pkh && k < dsRows)
+            {
+                if (!mlsag_load_points(&ge1, &gh, &pkh[(i + k*nCols)*128], &pk[(i + k*nCols)*33]))
+                    return 1;
+            } else
+            {
+                if (!secp256k1_eckey_pubkey_parse(&ge1, &pk[(i + k*nCols)*33], 33))
+                    return 1;
+            };
             secp256k1_gej_set_ge(&gej1, &ge1);
-            secp256k1_ecmult(&ctx->ecmult_ctx, &L, &gej1, &clast, &ss);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &lrj[k], &gej1, clast, &ss);
 
-            /* R = H(pk[k][i]) * ss + ki[k] * clast */
-            if (0 != hash_to_curve(&ge1, &pk[(i + k*nCols)*33], 33)) /* H(pk[k][i]) */
-                return 1;
-            secp256k1_gej_set_ge(&gej1, &ge1);
-            secp256k1_ecmult(&ctx->ecmult_ctx, &gej1, &gej1, &ss, &zero); /* gej1 = H(pk[k][i]) * ss */
+            if (k >= dsRows)
+                continue;
 
-            if (!secp256k1_eckey_pubkey_parse(&ge1, &ki[k * 33], 33))
+            /* R = H(pk[k][i]) * ss + ki[k] * clast */
+            if (!pkh && 0 != hash_to_curve(&gh, &pk[(i + k*nCols)*33], 33)) /* H(pk[k][i]) */
                 return 1;
-            secp256k1_gej_set_ge(&gej2, &ge1);
-            secp256k1_ecmult(&ctx->ecmult_ctx, &gej2, &gej2, &clast, &zero); /* gej2 = ki[k] * clast */
+            mlsag_ecmult_2(&lrj[nRows + k], &gh, &ss, &tki[k], clast);
+        };
 
-            secp256k1_gej_add_var(&R, &gej1, &gej2, NULL);  /* R =  gej1 + gej2 */
+        mlsag_ge_set_all_gej(lr, lrj, nRows + dsRows, az, azi);
 
+        for (k = 0; k < nRows; ++k)
+        {
+            /* An infinite L or R is not serialized, the previous contents of tmp are hashed in its place */
             secp256k1_sha256_write(&sha256_m, &pk[(i + k*nCols)*33], 33); /* pk[k][i] */
-            secp256k1_ge_set_gej(&ge1, &L);
-            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
+            secp256k1_eckey_pubkey_serialize(&lr[k], tmp, &clen, 1);
             secp256k1_sha256_write(&sha256_m, tmp, 33); /* L */
-            secp256k1_ge_set_gej(&ge1, &R);
-            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
-            secp256k1_sha256_write(&sha256_m, tmp, 33); /* R */
+            if (k < dsRows)
+            {
+                secp256k1_eckey_pubkey_serialize(&lr[nRows + k], tmp, &clen, 1);
+                secp256k1_sha256_write(&sha256_m, tmp, 33); /* R */
+            };
         };
 
-        for (k = dsRows; k < nRows; ++k)
-        {
-            /* L = G * ss + pk[k][i] * clast */
-            secp256k1_scalar_set_b32(&ss, &ps[(i + k*nCols)*32], &overflow);
-            if (overflow || secp256k1_scalar_is_zero(&ss))
-                return 1;
+        secp256k1_sha256_finalize(&sha256_m, tmp);
+        secp256k1_scalar_set_b32(clast, tmp, &overflow);
+        if (overflow || secp256k1_scalar_is_zero(clast))
+            return 1;
+    };
 
-            if (!secp256k1_eckey_pubkey_parse(&ge1, &pk[(i + k*nCols)*33], 33))
-                return 1;
+    return 0;
+}
 
-            secp256k1_gej_set_ge(&gej1, &ge1);
-            secp256k1_ecmult(&ctx->ecmult_ctx, &L, &gej1, &clast, &ss);
+static int mlsag_verify(const secp256k1_context *ctx,
+    const uint8_t *preimage, size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *pkh, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps)
+{
+    secp256k1_sha256_t sha256_pre;
+    secp256k1_scalar clast, cSig, diff;
+    size_t dsRows = nRows-1; /* TODO: pass in dsRows explicitly? */
+    int overflow, rv;
 
-            secp256k1_sha256_write(&sha256_m, &pk[(i + k*nCols)*33], 33); /* pk[k][i] */
-            secp256k1_ge_set_gej(&ge1, &L);
-            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
-            secp256k1_sha256_write(&sha256_m, tmp, 33); /* L */
-        };
+    secp256k1_scalar_set_b32(&clast, pc, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&clast))
+        return 1;
 
-        secp256k1_sha256_finalize(&sha256_m, tmp);
-        secp256k1_scalar_set_b32(&clast, tmp, &overflow);
-        if (overflow || secp256k1_scalar_is_zero(&clast))
+    cSig = clast;
+
+    secp256k1_sha256_initialize(&sha256_pre);
+    secp256k1_sha256_write(&sha256_pre, preimage, 32);
+
+    if (nCols > 0)
+    {
+        mlsag_ki_table *tki;
+        secp256k1_gej *lrj;
+        secp256k1_ge *lr;
+        secp256k1_fe *az, *azi;
+
+        if (nRows < 1)
             return 1;
+
+        tki = (mlsag_ki_table*)checked_malloc(&ctx->error_callback, sizeof(mlsag_ki_table) * (dsRows > 0 ? dsRows : 1));
+        lrj = (secp256k1_gej*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_gej) * (nRows + dsRows));
+        lr = (secp256k1_ge*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * (nRows + dsRows));
+        az = (secp256k1_fe*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_fe) * (nRows + dsRows));
+        azi = (secp256k1_fe*)checked_malloc(&ctx->error_callback, sizeof(secp256k1_fe) * (nRows + dsRows));
+
+        rv = mlsag_verify_columns(ctx, &clast, &sha256_pre, nCols, nRows,
+            pk, pkh, ki, ps, tki, lrj, lr, az, azi);
+
+        free(azi);
+        free(az);
+        free(lr);
+        free(lrj);
+        free(tki);
+
+        if (rv != 0)
+            return rv;
     };
 
     secp256k1_scalar_negate(&cSig, &cSig);
-    secp256k1_scalar_add(&zero, &clast, &cSig);
+    secp256k1_scalar_add(&diff, &clast, &cSig);
+
+    return secp256k1_scalar_is_zero(&diff) ? 0 : 2; /* return 0 on success, 2 on failure */
+}
 
-    return secp256k1_scalar_is_zero(&zero) ? 0 : 2; /* return 0 on success, 2 on failure */
+int secp256k1_verify_mlsag(const secp256k1_context *ctx,
+    const uint8_t *preimage, size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps)
+{
+    return mlsag_verify(ctx, preimage, nCols, nRows, pk, NULL, ki, pc, ps);
+}
+
+int secp256k1_verify_mlsag_points(const secp256k1_context *ctx,
+    const uint8_t *preimage, size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *pkh, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps)
+{
+    return mlsag_verify(ctx, preimage, nCols, nRows, pk, pkh, ki, pc, ps);
 }
 
 #endif
\ No newline at end of file
@@ -11,6 +11,144 @@
 
 static int mlsag_count = 32;
 
+/* secp256k1_verify_mlsag as it was before the L/R computation was batched,
+ * one secp256k1_ecmult and one inversion per point. */
+static int test_verify_mlsag_reference(const secp256k1_context *ctx,
+    const uint8_t *preimage, size_t nCols, size_t nRows,
+    const uint8_t *pk, const uint8_t *ki, const uint8_t *pc, const uint8_t *ps)
+{
+    secp256k1_sha256_t sha256_m, sha256_pre;
+    secp256k1_scalar zero, clast, cSig, ss;
+    secp256k1_ge ge1;
+    secp256k1_gej gej1, gej2, L, R;
+    size_t dsRows = nRows-1; /* TODO: pass in dsRows explicitly? */
+    uint8_t tmp[33];
+    size_t i, k, clen;
+    int overflow;
+
+    secp256k1_scalar_set_int(&zero, 0);
+
+    secp256k1_scalar_set_b32(&clast, pc, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&clast))
+        return 1;
+
+    cSig = clast;
+
+    secp256k1_sha256_initialize(&sha256_m);
+    secp256k1_sha256_write(&sha256_m, preimage, 32);
+    sha256_pre = sha256_m;
+
+    for (i = 0; i < nCols; ++i)
+    {
+        sha256_m = sha256_pre; /* set to after preimage hashed */
+
+        for (k = 0; k < dsRows; ++k)
+        {
+            /* L = G * ss + pk[k][i] * clast */
+            secp256k1_scalar_set_b32(&ss, &ps[(i + k*nCols)*32], &overflow);
+            if (overflow || secp256k1_scalar_is_zero(&ss))
+                return 1;
+            if (!secp256k1_eckey_pubkey_parse(&ge1, &pk[(i + k*nCols)*33], 33))
+                return 1;
+            secp256k1_gej_set_ge(&gej1, &ge1);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &L, &gej1, &clast, &ss);
+
+            /* R = H(pk[k][i]) * ss + ki[k] * clast */
+            if (0 != hash_to_curve(&ge1, &pk[(i + k*nCols)*33], 33)) /* H(pk[k][i]) */
+                return 1;
+            secp256k1_gej_set_ge(&gej1, &ge1);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &gej1, &gej1, &ss, &zero); /* gej1 = H(pk[k][i]) * ss */
+
+            if (!secp256k1_eckey_pubkey_parse(&ge1, &ki[k * 33], 33))
+                return 1;
+            secp256k1_gej_set_ge(&gej2, &ge1);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &gej2, &gej2, &clast, &zero); /* gej2 = ki[k] * clast */
+
+            secp256k1_gej_add_var(&R, &gej1, &gej2, NULL);  /* R =  gej1 + gej2 */
+
+            secp256k1_sha256_write(&sha256_m, &pk[(i + k*nCols)*33], 33); /* pk[k][i] */
+            secp256k1_ge_set_gej(&ge1, &L);
+            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
+            secp256k1_sha256_write(&sha256_m, tmp, 33); /* L */
+            secp256k1_ge_set_gej(&ge1, &R);
+            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
+            secp256k1_sha256_write(&sha256_m, tmp, 33); /* R */
+        };
+
+        for (k = dsRows; k < nRows; ++k)
+        {
+            /* L = G * ss + pk[k][i] * clast */
+            secp256k1_scalar_set_b32(&ss, &ps[(i + k*nCols)*32], &overflow);
+            if (overflow || secp256k1_scalar_is_zero(&ss))
+                return 1;
+
+            if (!secp256k1_eckey_pubkey_parse(&ge1, &pk[(i + k*nCols)*33], 33))
+                return 1;
+
+            secp256k1_gej_set_ge(&gej1, &ge1);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &L, &gej1, &clast, &ss);
+
+            secp256k1_sha256_write(&sha256_m, &pk[(i + k*nCols)*33], 33); /* pk[k][i] */
+            secp256k1_ge_set_gej(&ge1, &L);
+            secp256k1_eckey_pubkey_serialize(&ge1, tmp, &clen, 1);
+            secp256k1_sha256_write(&sha256_m, tmp, 33); /* L */
+        };
+
+        secp256k1_sha256_finalize(&sha256_m, tmp);
+        secp256k1_scalar_set_b32(&clast, tmp, &overflow);
+        if (overflow || secp256k1_scalar_is_zero(&clast))
+            return 1;
+    };
+
+    secp256k1_scalar_negate(&cSig, &cSig);
+    secp256k1_scalar_add(&zero, &clast, &cSig);
+
+    return secp256k1_scalar_is_zero(&zero) ? 0 : 2; /* return 0 on success, 2 on failure */
+}
+
+/* Check that the verifier agrees with the reference for the signature and
+ * for single byte corruptions of every input. */
+static void test_mlsag_reference_agreement(const uint8_t *preimage, size_t nCols, size_t nRows,
+    uint8_t *pk, uint8_t *ki, uint8_t *pc, uint8_t *ps)
+{
+    uint8_t *bufs[4];
+    size_t lens[4];
+    size_t t, pos;
+    uint8_t saved, saved_ss[32];
+
+    bufs[0] = pk; lens[0] = nCols * nRows * 33;
+    bufs[1] = ki; lens[1] = (nRows - 1) * 33;
+    bufs[2] = pc; lens[2] = 32;
+    bufs[3] = ps; lens[3] = nCols * nRows * 32;
+
+    CHECK(secp256k1_verify_mlsag(ctx, preimage, nCols, nRows, pk, ki, pc, ps)
+        == test_verify_mlsag_reference(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+
+    for (t = 0; t < 8; ++t)
+    {
+        size_t b = secp256k1_rand_int(4);
+        if (lens[b] == 0)
+            continue;
+        pos = secp256k1_rand_int(lens[b]);
+        saved = bufs[b][pos];
+        bufs[b][pos] ^= (uint8_t)(1 + secp256k1_rand_int(255));
+        CHECK(secp256k1_verify_mlsag(ctx, preimage, nCols, nRows, pk, ki, pc, ps)
+            == test_verify_mlsag_reference(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+        bufs[b][pos] = saved;
+    };
+
+    /* Overflowing and zero ss */
+    pos = secp256k1_rand_int(nCols * nRows) * 32;
+    memcpy(saved_ss, &ps[pos], 32);
+    memset(&ps[pos], 0xff, 32);
+    CHECK(1 == secp256k1_verify_mlsag(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+    CHECK(1 == test_verify_mlsag_reference(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+    memset(&ps[pos], 0, 32);
+    CHECK(1 == secp256k1_verify_mlsag(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+    CHECK(1 == test_verify_mlsag_reference(ctx, preimage, nCols, nRows, pk, ki, pc, ps));
+    memcpy(&ps[pos], saved_ss, 32);
+}
+
 #define MAX_N_INPUTS  32
 #define MAX_N_OUTPUTS 32
 #define MAX_N_COLUMNS 32
@@ -41,6 +179,8 @@ void test_mlsag(void)
     uint8_t pc[32];
     uint8_t ki[MAX_N_INPUTS * 33];
     uint8_t ss[(MAX_N_INPUTS+1) * MAX_N_COLUMNS * 33]; /* max_rows * max_cols */
+    uint8_t pkh[MAX_N_INPUTS * MAX_N_COLUMNS * 128];
+    secp256k1_fe fe;
 
     secp256k1_rand256(preimage);
 
@@ -125,6 +265,38 @@ void test_mlsag(void)
     CHECK(0 == secp256k1_verify_mlsag(ctx,
         preimage, n_columns, n_rows,
         m, ki, pc, ss));
+    test_mlsag_reference_agreement(preimage, n_columns, n_rows, m, ki, pc, ss);
+
+    /* Precomputed pubkey and H(pk) points */
+    for (k = 0; k < n_inputs; ++k)
+    for (i = 0; i < n_columns; ++i)
+        CHECK(0 == secp256k1_get_mlsag_points(&pkh[(i+k*n_columns)*128], &m[(i+k*n_columns)*33]));
+    CHECK(0 == secp256k1_verify_mlsag_points(ctx,
+        preimage, n_columns, n_rows,
+        m, pkh, ki, pc, ss));
+    CHECK(2 == secp256k1_verify_mlsag_points(ctx,
+        preimage, n_columns, n_rows,
+        m, pkh, ki, tmp32, ss));
+
+    /* Points that are not on the curve or do not match pk */
+    i = secp256k1_rand_int(n_columns * n_inputs) * 128;
+    pkh[i + 63] ^= 1;
+    CHECK(1 == secp256k1_verify_mlsag_points(ctx,
+        preimage, n_columns, n_rows,
+        m, pkh, ki, pc, ss));
+    pkh[i + 63] ^= 1;
+    pkh[i + 127] ^= 1;
+    CHECK(1 == secp256k1_verify_mlsag_points(ctx,
+        preimage, n_columns, n_rows,
+        m, pkh, ki, pc, ss));
+    pkh[i + 127] ^= 1;
+    secp256k1_fe_set_b32(&fe, &pkh[i + 32]);
+    secp256k1_fe_negate(&fe, &fe, 1);
+    secp256k1_fe_normalize_var(&fe);
+    secp256k1_fe_get_b32(&pkh[i + 32], &fe); /* -pk, still on the curve */
+    CHECK(1 == secp256k1_verify_mlsag_points(ctx,
+        preimage, n_columns, n_rows,
+        m, pkh, ki, pc, ss));
 
 
     /* --- Test for failure --- */
@@ -41,6 +41,9 @@ SECP256K1_INLINE static void secp256k1_borromean_hash(unsigned char *hash, const
     secp256k1_sha256_finalize(&sha256_en, hash);
 }
 
+/* Rings verified side by side; more rings are taken in groups of this many. */
+#define SECP256K1_BORROMEAN_VERIFY_RINGS 32
+
 /**  "Borromean" ring signature.
  *   Verifies nrings concurrent ring signatures all sharing a challenge value.
  *   Signature is one s value per pubkey and a hash.
@@ -54,19 +57,32 @@ SECP256K1_INLINE static void secp256k1_borromean_hash(unsigned char *hash, const
  *   | | | en = to_scalar(e)
  *   | | r_i = r
  *   | return e_0 ==== H(r_{0..i}||m)
+ *   Each ring is a sequential chain, but the rings are independent: step j is
+ *   taken in all rings together so one field inversion converts every r to
+ *   affine form.
  */
 int secp256k1_borromean_verify(const secp256k1_ecmult_context* ecmult_ctx, secp256k1_scalar *evalues, const unsigned char *e0,
  const secp256k1_scalar *s, const secp256k1_gej *pubs, const size_t *rsizes, size_t nrings, const unsigned char *m, size_t mlen) {
-    secp256k1_gej rgej;
+    secp256k1_gej rgej[SECP256K1_BORROMEAN_VERIFY_RINGS];
     secp256k1_ge rge;
-    secp256k1_scalar ens;
+    secp256k1_fe az[SECP256K1_BORROMEAN_VERIFY_RINGS];
+    secp256k1_fe azi[SECP256K1_BORROMEAN_VERIFY_RINGS];
+    secp256k1_scalar ens[SECP256K1_BORROMEAN_VERIFY_RINGS];
+    size_t offset[SECP256K1_BORROMEAN_VERIFY_RINGS];
+    size_t active[SECP256K1_BORROMEAN_VERIFY_RINGS];
+    unsigned char rlast[SECP256K1_BORROMEAN_VERIFY_RINGS][33];
     secp256k1_sha256_t sha256_e0;
     unsigned char tmp[33];
+    size_t first;
+    size_t nbatch;
+    size_t nactive;
+    size_t maxsize;
     size_t i;
     size_t j;
+    size_t k;
     size_t count;
     size_t size;
-    int overflow;
+    int overflow[SECP256K1_BORROMEAN_VERIFY_RINGS];
     VERIFY_CHECK(ecmult_ctx != NULL);
     VERIFY_CHECK(e0 != NULL);
     VERIFY_CHECK(s != NULL);
@@ -76,32 +92,58 @@ int secp256k1_borromean_verify(const secp256k1_ecmult_context* ecmult_ctx, secp2
     VERIFY_CHECK(m != NULL);
     count = 0;
     secp256k1_sha256_initialize(&sha256_e0);
-    for (i = 0; i < nrings; i++) {
-        VERIFY_CHECK(INT_MAX - count > rsizes[i]);
-        secp256k1_borromean_hash(tmp, m, mlen, e0, 32, i, 0);
-        secp256k1_scalar_set_b32(&ens, tmp, &overflow);
-        for (j = 0; j < rsizes[i]; j++) {
-            if (overflow || secp256k1_scalar_is_zero(&s[count]) || secp256k1_scalar_is_zero(&ens) || secp256k1_gej_is_infinity(&pubs[count])) {
-                return 0;
+    for (first = 0; first < nrings; first += nbatch) {
+        nbatch = nrings - first < SECP256K1_BORROMEAN_VERIFY_RINGS ? nrings - first : SECP256K1_BORROMEAN_VERIFY_RINGS;
+        maxsize = 0;
+        for (i = 0; i < nbatch; i++) {
+            VERIFY_CHECK(INT_MAX - count > rsizes[first + i]);
+            offset[i] = count;
+            count += rsizes[first + i];
+            if (rsizes[first + i] > maxsize) {
+                maxsize = rsizes[first + i];
             }
-            if (evalues) {
-                /*If requested, save the challenges for proof rewind.*/
-                evalues[count] = ens;
+            secp256k1_borromean_hash(tmp, m, mlen, e0, 32, first + i, 0);
+            secp256k1_scalar_set_b32(&ens[i], tmp, &overflow[i]);
+        }
+        for (j = 0; j < maxsize; j++) {
+            nactive = 0;
+            for (i = 0; i < nbatch; i++) {
+                size_t idx = offset[i] + j;
+                if (j >= rsizes[first + i]) {
+                    continue;
+                }
+                if (overflow[i] || secp256k1_scalar_is_zero(&s[idx]) || secp256k1_scalar_is_zero(&ens[i]) || secp256k1_gej_is_infinity(&pubs[idx])) {
+                    return 0;
+                }
+                if (evalues) {
+                    /*If requested, save the challenges for proof rewind.*/
+                    evalues[idx] = ens[i];
+                }
+                secp256k1_ecmult(ecmult_ctx, &rgej[nactive], &pubs[idx], &ens[i], &s[idx]);
+                if (secp256k1_gej_is_infinity(&rgej[nactive])) {
+                    return 0;
+                }
+                az[nactive] = rgej[nactive].z;
+                active[nactive++] = i;
             }
-            secp256k1_ecmult(ecmult_ctx, &rgej, &pubs[count], &ens, &s[count]);
-            if (secp256k1_gej_is_infinity(&rgej)) {
-                return 0;
+            secp256k1_fe_inv_all_var(azi, az, nactive);
+            for (k = 0; k < nactive; k++) {
+                i = active[k];
+                secp256k1_ge_set_gej_zinv(&rge, &rgej[k], &azi[k]);
+                if (j != rsizes[first + i] - 1) {
+                    secp256k1_eckey_pubkey_serialize(&rge, tmp, &size, 1);
+                    secp256k1_borromean_hash(tmp, m, mlen, tmp, 33, first + i, j + 1);
+                    secp256k1_scalar_set_b32(&ens[i], tmp, &overflow[i]);
+                } else {
+                    secp256k1_eckey_pubkey_serialize(&rge, rlast[i], &size, 1);
+                }
             }
-            /* OPT: loop can be hoisted and split to use batch inversion across all the rings; this would make it much faster. */
-            secp256k1_ge_set_gej_var(&rge, &rgej);
-            secp256k1_eckey_pubkey_serialize(&rge, tmp, &size, 1);
-            if (j != rsizes[i] - 1) {
-                secp256k1_borromean_hash(tmp, m, mlen, tmp, 33, i, j + 1);
-                secp256k1_scalar_set_b32(&ens, tmp, &overflow);
-            } else {
-                secp256k1_sha256_write(&sha256_e0, tmp, size);
+        }
+        /* The last r of every ring goes into e0 in ring order */
+        for (i = 0; i < nbatch; i++) {
+            if (rsizes[first + i] > 0) {
+                secp256k1_sha256_write(&sha256_e0, rlast[i], 33);
             }
-            count++;
         }
     }
     secp256k1_sha256_write(&sha256_e0, m, mlen);
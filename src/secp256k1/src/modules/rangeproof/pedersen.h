@@ -13,10 +13,32 @@
 
 #include <stdint.h>
 
-/** Multiply a small number with the generator: r = gn*G2 */
-static void secp256k1_pedersen_ecmult_small(secp256k1_gej *r, uint64_t gn, const secp256k1_ge* genp);
+typedef struct {
+    /* For accelerating the computation of value*G2 for a fixed G2 and 64-bit values, in
+     * the same way as secp256k1_ecmult_gen_context does for a*G:
+     * * Break up the value into groups of 4 bits, called n_0, n_1, n_2, ..., n_15.
+     * * Compute sum(n_i * 16^i * G2 + U_i, i=0..15), where:
+     *   * U_i = U * 2^i (for i=0..14)
+     *   * U_i = U * (1-2^15) (for i=15)
+     *   where U is a point with no known corresponding scalar. Note that sum(U_i, i=0..15) = 0.
+     * Only G2 itself is multiplied with the table, other generators fall back to
+     * secp256k1_ecmult_const.
+     */
+    secp256k1_ge_storage (*prec)[16][16]; /* prec[j][i] = 16^j * i * G2 + U_i */
+    secp256k1_ge gen;
+} secp256k1_pedersen_context;
+
+static void secp256k1_pedersen_context_init(secp256k1_pedersen_context* ctx);
+static void secp256k1_pedersen_context_build(secp256k1_pedersen_context* ctx, const secp256k1_ge* gen, const secp256k1_callback* cb);
+static void secp256k1_pedersen_context_clone(secp256k1_pedersen_context *dst,
+                                             const secp256k1_pedersen_context* src, const secp256k1_callback* cb);
+static void secp256k1_pedersen_context_clear(secp256k1_pedersen_context* ctx);
+static int secp256k1_pedersen_context_is_built(const secp256k1_pedersen_context* ctx);
+
+/** Multiply a small number with the generator: r = gn*G2. pedersen_ctx may be NULL. */
+static void secp256k1_pedersen_ecmult_small(const secp256k1_pedersen_context *pedersen_ctx, secp256k1_gej *r, uint64_t gn, const secp256k1_ge* genp);
 
 /* sec * G + value * G2. */
-static void secp256k1_pedersen_ecmult(const secp256k1_ecmult_gen_context *ecmult_gen_ctx, secp256k1_gej *rj, const secp256k1_scalar *sec, uint64_t value, const secp256k1_ge* genp);
+static void secp256k1_pedersen_ecmult(const secp256k1_ecmult_gen_context *ecmult_gen_ctx, const secp256k1_pedersen_context *pedersen_ctx, secp256k1_gej *rj, const secp256k1_scalar *sec, uint64_t value, const secp256k1_ge* genp);
 
 #endif
\ No newline at end of file
@@ -75,6 +75,76 @@ static void test_pedersen(void) {
     CHECK(secp256k1_pedersen_verify_tally(ctx, &cptr[1], 1, &cptr[1], 1));
 }
 
+static void test_pedersen_precomputed(void) {
+    secp256k1_context *pctx;
+    secp256k1_context *cctx;
+    secp256k1_pedersen_commitment commit1;
+    secp256k1_pedersen_commitment commit2;
+    secp256k1_generator gen;
+    secp256k1_ge genp;
+    secp256k1_gej r1;
+    secp256k1_gej r2;
+    secp256k1_scalar s;
+    unsigned char blind[32];
+    unsigned char proof[5134];
+    size_t len;
+    uint64_t min_value;
+    uint64_t max_value;
+    uint64_t value;
+    int i;
+
+    pctx = secp256k1_context_clone(ctx);
+    CHECK(!secp256k1_pedersen_context_is_built(&pctx->pedersen_ctx));
+    secp256k1_pedersen_context_initialize(pctx);
+    CHECK(secp256k1_pedersen_context_is_built(&pctx->pedersen_ctx));
+    cctx = secp256k1_context_clone(pctx);
+    CHECK(secp256k1_pedersen_context_is_built(&cctx->pedersen_ctx));
+    secp256k1_context_destroy(pctx);
+
+    /* The table gives the same multiples of H as generic multiplication, for every nibble. */
+    secp256k1_generator_load(&genp, secp256k1_generator_h);
+    for (i = 0; i < 64 + 10*rangeproof_count; i++) {
+        if (i < 64) {
+            value = (i & 1 ? ~(uint64_t)0 : (uint64_t)0) ^ ((uint64_t)15 << (i & ~3));
+        } else {
+            value = (uint64_t)secp256k1_rand32() << 32 | secp256k1_rand32();
+        }
+        secp256k1_pedersen_ecmult_small(&cctx->pedersen_ctx, &r1, value, &genp);
+        secp256k1_pedersen_ecmult_small(NULL, &r2, value, &genp);
+        secp256k1_gej_neg(&r2, &r2);
+        secp256k1_gej_add_var(&r1, &r1, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r1));
+    }
+    secp256k1_pedersen_ecmult_small(&cctx->pedersen_ctx, &r1, 0, &genp);
+    CHECK(secp256k1_gej_is_infinity(&r1));
+
+    /* Commitments and proofs agree between contexts with and without the table. */
+    for (i = 0; i < rangeproof_count; i++) {
+        random_scalar_order(&s);
+        secp256k1_scalar_get_b32(blind, &s);
+        value = secp256k1_rands64(0, UINT64_MAX);
+        CHECK(secp256k1_pedersen_commit(ctx, &commit1, blind, value, secp256k1_generator_h));
+        CHECK(secp256k1_pedersen_commit(cctx, &commit2, blind, value, secp256k1_generator_h));
+        CHECK(memcmp(&commit1, &commit2, sizeof(commit1)) == 0);
+    }
+    value = 1 + secp256k1_rands64(0, 1000000);
+    CHECK(secp256k1_pedersen_commit(cctx, &commit1, blind, value, secp256k1_generator_h));
+    len = sizeof(proof);
+    CHECK(secp256k1_rangeproof_sign(cctx, proof, &len, 1, &commit1, blind, commit1.data, 0, 0, value, NULL, 0, NULL, 0, secp256k1_generator_h));
+    CHECK(secp256k1_rangeproof_verify(ctx, &min_value, &max_value, &commit1, proof, len, NULL, 0, secp256k1_generator_h));
+    CHECK(secp256k1_rangeproof_verify(cctx, &min_value, &max_value, &commit1, proof, len, NULL, 0, secp256k1_generator_h));
+    CHECK(min_value == 1);
+
+    /* Other generators do not use the table. */
+    secp256k1_rand256(blind);
+    CHECK(secp256k1_generator_generate(ctx, &gen, blind));
+    CHECK(secp256k1_pedersen_commit(ctx, &commit1, blind, value, &gen));
+    CHECK(secp256k1_pedersen_commit(cctx, &commit2, blind, value, &gen));
+    CHECK(memcmp(&commit1, &commit2, sizeof(commit1)) == 0);
+
+    secp256k1_context_destroy(cctx);
+}
+
 static void test_borromean(void) {
     unsigned char e0[32];
     secp256k1_scalar s[64];
@@ -362,6 +432,7 @@ void run_rangeproof_tests(void) {
     for (i = 0; i < 10*rangeproof_count; i++) {
         test_pedersen();
     }
+    test_pedersen_precomputed();
     for (i = 0; i < 10*rangeproof_count; i++) {
         test_borromean();
     }
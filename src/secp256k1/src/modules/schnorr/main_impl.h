@@ -70,6 +70,117 @@ int secp256k1_schnorr_verify(const secp256k1_context* ctx, const unsigned char *
     return secp256k1_schnorr_sig_verify(&ctx->ecmult_ctx, sig64, &q, secp256k1_schnorr_msghash_sha256, msg32);
 }
 
+typedef struct {
+    const secp256k1_context *ctx;
+    unsigned char seed[32];
+    const unsigned char * const *sig64;
+    const unsigned char * const *msg32;
+    const secp256k1_pubkey * const *pubkey;
+} secp256k1_schnorr_verify_batch_data;
+
+/* Randomizer a_i of signature i, derived from a hash of the whole batch */
+static void secp256k1_schnorr_batch_randomizer(secp256k1_scalar *a, const unsigned char *seed32, size_t i) {
+    secp256k1_sha256_t sha;
+    unsigned char buf[32];
+    unsigned char idx[4];
+    idx[0] = i >> 24;
+    idx[1] = i >> 16;
+    idx[2] = i >> 8;
+    idx[3] = i;
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, seed32, 32);
+    secp256k1_sha256_write(&sha, idx, 4);
+    secp256k1_sha256_finalize(&sha, buf);
+    secp256k1_scalar_set_b32(a, buf, NULL);
+}
+
+/* Term 2i is (a_i * h_i) * Q_i and term 2i+1 is -a_i * R_i */
+static int secp256k1_schnorr_verify_batch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    secp256k1_schnorr_verify_batch_data *data = (secp256k1_schnorr_verify_batch_data*)cbdata;
+    const unsigned char *sig64 = data->sig64[idx / 2];
+    secp256k1_scalar a;
+
+    secp256k1_schnorr_batch_randomizer(&a, data->seed, idx / 2);
+    if (idx % 2 == 0) {
+        unsigned char hh[32];
+        int overflow = 0;
+        secp256k1_schnorr_msghash_sha256(hh, sig64, data->msg32[idx / 2]);
+        secp256k1_scalar_set_b32(sc, hh, &overflow);
+        if (overflow || secp256k1_scalar_is_zero(sc)) {
+            return 0;
+        }
+        secp256k1_pubkey_load(data->ctx, pt, data->pubkey[idx / 2]);
+        if (secp256k1_ge_is_infinity(pt)) {
+            return 0;
+        }
+        secp256k1_scalar_mul(sc, sc, &a);
+    } else {
+        secp256k1_fe rx;
+        if (!secp256k1_fe_set_b32(&rx, sig64) || !secp256k1_ge_set_xo_var(pt, &rx, 0)) {
+            return 0;
+        }
+        secp256k1_scalar_negate(sc, &a);
+    }
+    return 1;
+}
+
+int secp256k1_schnorr_verify_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const unsigned char * const *sig64, const unsigned char * const *msg32, const secp256k1_pubkey * const *pubkey, size_t n) {
+    secp256k1_schnorr_verify_batch_data data;
+    secp256k1_sha256_t sha;
+    secp256k1_scalar sum, s, a;
+    secp256k1_gej rj;
+    size_t i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(sig64 != NULL || n == 0);
+    ARG_CHECK(msg32 != NULL || n == 0);
+    ARG_CHECK(pubkey != NULL || n == 0);
+
+    if (n == 0) {
+        return 1;
+    }
+    if (n == 1) {
+        secp256k1_ge q;
+        secp256k1_pubkey_load(ctx, &q, pubkey[0]);
+        return secp256k1_schnorr_sig_verify(&ctx->ecmult_ctx, sig64[0], &q, secp256k1_schnorr_msghash_sha256, msg32[0]);
+    }
+    if (n > SIZE_MAX / 2) {
+        return 0;
+    }
+
+    /* The randomizers commit to every input, so signatures cannot be chosen
+     * to cancel each other out. */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n; i++) {
+        secp256k1_sha256_write(&sha, sig64[i], 64);
+        secp256k1_sha256_write(&sha, msg32[i], 32);
+        secp256k1_sha256_write(&sha, pubkey[i]->data, sizeof(pubkey[i]->data));
+    }
+    secp256k1_sha256_finalize(&sha, data.seed);
+
+    secp256k1_scalar_clear(&sum);
+    for (i = 0; i < n; i++) {
+        int overflow = 0;
+        secp256k1_scalar_set_b32(&s, sig64[i] + 32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+        secp256k1_schnorr_batch_randomizer(&a, data.seed, i);
+        secp256k1_scalar_mul(&s, &s, &a);
+        secp256k1_scalar_add(&sum, &sum, &s);
+    }
+
+    data.ctx = ctx;
+    data.sig64 = sig64;
+    data.msg32 = msg32;
+    data.pubkey = pubkey;
+    /* sum(a_i * (h_i * Q_i - R_i)) + sum(a_i * s_i) * G == 0 */
+    if (!secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &rj, &sum, secp256k1_schnorr_verify_batch_callback, &data, 2 * n)) {
+        return 0;
+    }
+    return secp256k1_gej_is_infinity(&rj);
+}
+
 int secp256k1_schnorr_recover(const secp256k1_context* ctx, secp256k1_pubkey *pubkey, const unsigned char *sig64, const unsigned char *msg32) {
     secp256k1_ge q;
 
@@ -156,6 +156,74 @@ void test_schnorr_recovery(void) {
     }
 }
 
+void test_schnorr_verify_batch(secp256k1_scratch_space *scratch) {
+    unsigned char privkey[32];
+    unsigned char msg[40][32];
+    unsigned char sig[40][64];
+    secp256k1_pubkey pubkey[40];
+    const unsigned char *sigptr[40];
+    const unsigned char *msgptr[40];
+    const secp256k1_pubkey *pkptr[40];
+    size_t n = 1 + secp256k1_rand_int(40);
+    size_t i, j;
+
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey, &key);
+        secp256k1_rand256_test(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], privkey) == 1);
+        CHECK(secp256k1_schnorr_sign(ctx, sig[i], msg[i], privkey, NULL, NULL) == 1);
+        sigptr[i] = sig[i];
+        msgptr[i] = msg[i];
+        pkptr[i] = &pubkey[i];
+    }
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 1);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, NULL, NULL, NULL, 0) == 1);
+
+    /* A damaged signature fails the batch exactly when it fails on its own */
+    j = secp256k1_rand_int(n);
+    sig[j][secp256k1_rand_bits(6)] ^= 1 << secp256k1_rand_bits(3);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == secp256k1_schnorr_verify(ctx, sig[j], msg[j], &pubkey[j]));
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 0);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, &sigptr[j], &msgptr[j], &pkptr[j], 1) == 0);
+    sigptr[j] = sig[(j + 1) % n];
+    if (n > 1) {
+        /* A valid signature under another key */
+        CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 0);
+    }
+    /* Overflowing s */
+    memset(sig[j] + 32, 0xff, 32);
+    sigptr[j] = sig[j];
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 0);
+    /* R not on the curve or not a field element */
+    memset(sig[j], 0xff, 32);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 0);
+
+    /* Two invalid signatures that cancel in an unweighted sum */
+    CHECK(secp256k1_schnorr_sign(ctx, sig[j], msg[j], privkey, NULL, NULL) == 1);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[j], privkey) == 1);
+    CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 1);
+    if (n > 1) {
+        unsigned char sig0[64], sig1[64];
+        secp256k1_scalar s0, s1, delta;
+        memcpy(sig0, sig[0], 64);
+        memcpy(sig1, sig[1], 64);
+        secp256k1_scalar_set_b32(&s0, sig[0] + 32, NULL);
+        secp256k1_scalar_set_b32(&s1, sig[1] + 32, NULL);
+        random_scalar_order_test(&delta);
+        secp256k1_scalar_add(&s0, &s0, &delta);
+        secp256k1_scalar_negate(&delta, &delta);
+        secp256k1_scalar_add(&s1, &s1, &delta);
+        secp256k1_scalar_get_b32(sig[0] + 32, &s0);
+        secp256k1_scalar_get_b32(sig[1] + 32, &s1);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 0);
+        memcpy(sig[0], sig0, 64);
+        memcpy(sig[1], sig1, 64);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, scratch, sigptr, msgptr, pkptr, n) == 1);
+    }
+}
+
 void run_schnorr_tests(void) {
     int i;
     for (i = 0; i < 32*count; i++) {
@@ -170,6 +238,14 @@ void run_schnorr_tests(void) {
     for (i = 0; i < 10 * count; i++) {
          test_schnorr_threshold();
     }
+    {
+        secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1 << 20);
+        for (i = 0; i < 4 * count; i++) {
+            test_schnorr_verify_batch(scratch);
+        }
+        test_schnorr_verify_batch(NULL);
+        secp256k1_scratch_space_destroy(scratch);
+    }
 }
 
 #endif
\ No newline at end of file
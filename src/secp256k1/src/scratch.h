@@ -0,0 +1,44 @@
+/**********************************************************************
+ * Copyright (c) 2018 The Particl Core developers                     *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_SCRATCH_H
+#define SECP256K1_SCRATCH_H
+
+#define SECP256K1_SCRATCH_MAX_FRAMES 5
+
+/* A preallocated block handed out in nested frames, so the multi-point
+ * algorithms do not call malloc per point. The struct name is the public
+ * secp256k1_scratch_space. */
+typedef struct secp256k1_scratch_space_struct {
+    void *data;
+    size_t frame_start[SECP256K1_SCRATCH_MAX_FRAMES];
+    size_t frame_size[SECP256K1_SCRATCH_MAX_FRAMES];
+    size_t frame_saved_offset[SECP256K1_SCRATCH_MAX_FRAMES];
+    size_t frame;
+    size_t offset; /* next allocation in the top frame */
+    size_t max_size;
+    const secp256k1_callback* error_callback;
+} secp256k1_scratch;
+
+static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t max_size);
+
+static void secp256k1_scratch_destroy(secp256k1_scratch* scratch);
+
+/** Returns the maximum allocation the scratch space will allow, for n_objects
+ *  allocations that are each padded to the alignment */
+static size_t secp256k1_scratch_max_allocation(const secp256k1_scratch* scratch, size_t n_objects);
+
+/** Reserves n bytes (plus padding for n_objects allocations) as a new frame.
+ *  Returns 0 if there is not enough space left or no frame is free. */
+static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n, size_t n_objects);
+
+/** Releases the most recently allocated frame and everything taken from it */
+static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch);
+
+/** Returns a pointer to n bytes from the current frame, or NULL if it is exhausted */
+static void *secp256k1_scratch_alloc(secp256k1_scratch* scratch, size_t n);
+
+#endif
@@ -0,0 +1,84 @@
+/**********************************************************************
+ * Copyright (c) 2018 The Particl Core developers                     *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef SECP256K1_SCRATCH_IMPL_H
+#define SECP256K1_SCRATCH_IMPL_H
+
+#include "scratch.h"
+
+/* Enough for the alignment of every type allocated from a scratch space */
+#define ALIGNMENT 16
+
+#define ROUND_TO_ALIGN(size) ((((size) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT)
+
+static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t max_size) {
+    secp256k1_scratch* ret = (secp256k1_scratch*)checked_malloc(error_callback, sizeof(*ret));
+    if (ret != NULL) {
+        memset(ret, 0, sizeof(*ret));
+        ret->data = checked_malloc(error_callback, max_size);
+        if (ret->data == NULL) {
+            free(ret);
+            return NULL;
+        }
+        ret->max_size = max_size;
+        ret->error_callback = error_callback;
+    }
+    return ret;
+}
+
+static void secp256k1_scratch_destroy(secp256k1_scratch* scratch) {
+    if (scratch != NULL) {
+        VERIFY_CHECK(scratch->frame == 0);
+        free(scratch->data);
+        free(scratch);
+    }
+}
+
+static size_t secp256k1_scratch_max_allocation(const secp256k1_scratch* scratch, size_t n_objects) {
+    size_t used = scratch->frame > 0 ? scratch->frame_start[scratch->frame - 1] + scratch->frame_size[scratch->frame - 1] : 0;
+    size_t left = scratch->max_size - used;
+    if (scratch->frame == SECP256K1_SCRATCH_MAX_FRAMES || left <= n_objects * ALIGNMENT) {
+        return 0;
+    }
+    return left - n_objects * ALIGNMENT;
+}
+
+static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n, size_t n_objects) {
+    size_t start;
+    if (n > secp256k1_scratch_max_allocation(scratch, n_objects)) {
+        return 0;
+    }
+    start = scratch->frame > 0 ? scratch->frame_start[scratch->frame - 1] + scratch->frame_size[scratch->frame - 1] : 0;
+    scratch->frame_start[scratch->frame] = start;
+    scratch->frame_size[scratch->frame] = n + n_objects * ALIGNMENT;
+    scratch->frame_saved_offset[scratch->frame] = scratch->offset;
+    scratch->frame++;
+    scratch->offset = start;
+    return 1;
+}
+
+static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch) {
+    VERIFY_CHECK(scratch->frame > 0);
+    scratch->frame--;
+    scratch->offset = scratch->frame_saved_offset[scratch->frame];
+}
+
+static void *secp256k1_scratch_alloc(secp256k1_scratch* scratch, size_t size) {
+    void *ret;
+    size_t frame = scratch->frame - 1;
+    size = ROUND_TO_ALIGN(size);
+
+    if (scratch->frame == 0 || size + scratch->offset > scratch->frame_start[frame] + scratch->frame_size[frame]) {
+        return NULL;
+    }
+    ret = (void *) ((unsigned char *) scratch->data + scratch->offset);
+    memset(ret, 0, size);
+    scratch->offset += size;
+
+    return ret;
+}
+
+#endif
@@ -2537,6 +2537,150 @@ void run_ecmult_const_tests(void) {
     ecmult_const_chain_multiply();
 }
 
+typedef struct {
+    secp256k1_scalar *sc;
+    secp256k1_ge *pt;
+} ecmult_multi_data;
+
+static int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
+    *sc = data->sc[idx];
+    *pt = data->pt[idx];
+    return 1;
+}
+
+static int ecmult_multi_false_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    (void)sc;
+    (void)pt;
+    (void)idx;
+    (void)cbdata;
+    return 0;
+}
+
+/* Checks that r equals the sum of the first n terms plus g_sc * G */
+static void ecmult_multi_check(secp256k1_scratch *scratch, const secp256k1_scalar *g_sc, secp256k1_scalar *sc, secp256k1_ge *pt, size_t n) {
+    secp256k1_gej r, expected, tmp;
+    secp256k1_scalar szero;
+    ecmult_multi_data data;
+    size_t i;
+
+    data.sc = sc;
+    data.pt = pt;
+    secp256k1_scalar_set_int(&szero, 0);
+    secp256k1_gej_set_infinity(&expected);
+    if (g_sc != NULL) {
+        secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &expected, g_sc);
+    }
+    for (i = 0; i < n; i++) {
+        if (secp256k1_ge_is_infinity(&pt[i])) {
+            continue;
+        }
+        secp256k1_gej_set_ge(&tmp, &pt[i]);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &tmp, &tmp, &sc[i], &szero);
+        secp256k1_gej_add_var(&expected, &expected, &tmp, NULL);
+    }
+
+    CHECK(secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &r, g_sc, ecmult_multi_callback, &data, n));
+    secp256k1_gej_neg(&expected, &expected);
+    secp256k1_gej_add_var(&r, &r, &expected, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r));
+}
+
+void test_ecmult_multi(secp256k1_scratch *scratch) {
+    secp256k1_scalar sc[200];
+    secp256k1_ge pt[200];
+    secp256k1_scalar g_sc;
+    secp256k1_gej r;
+    ecmult_multi_data data;
+    static const size_t sizes[] = {0, 1, 2, 3, 5, 16, 87, 88, 89, 200};
+    size_t i, j;
+
+    for (i = 0; i < 200; i++) {
+        random_scalar_order(&sc[i]);
+        random_group_element_test(&pt[i]);
+    }
+    random_scalar_order(&g_sc);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        ecmult_multi_check(scratch, &g_sc, sc, pt, sizes[i]);
+        ecmult_multi_check(scratch, NULL, sc, pt, sizes[i]);
+    }
+
+    /* Zero scalars, infinite points and terms that cancel */
+    secp256k1_scalar_set_int(&sc[3], 0);
+    pt[7].infinity = 1;
+    pt[11] = pt[10];
+    secp256k1_scalar_negate(&sc[11], &sc[10]);
+    for (j = 0; j < 2; j++) {
+        ecmult_multi_check(scratch, &g_sc, sc, pt, 16);
+        ecmult_multi_check(scratch, &g_sc, sc, pt, 100);
+        secp256k1_scalar_set_int(&g_sc, 0);
+    }
+
+    /* Scalars of one and minus one */
+    for (i = 0; i < 100; i++) {
+        secp256k1_scalar_set_int(&sc[i], 1);
+        if (i & 1) {
+            secp256k1_scalar_negate(&sc[i], &sc[i]);
+        }
+    }
+    ecmult_multi_check(scratch, NULL, sc, pt, 16);
+    ecmult_multi_check(scratch, NULL, sc, pt, 100);
+
+    /* A failing callback fails the whole multiplication */
+    data.sc = sc;
+    data.pt = pt;
+    CHECK(!secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &r, NULL, ecmult_multi_false_callback, &data, 1));
+    CHECK(!secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &r, NULL, ecmult_multi_false_callback, &data, 100));
+    /* No terms at all */
+    CHECK(secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &r, NULL, ecmult_multi_false_callback, &data, 0));
+    CHECK(secp256k1_gej_is_infinity(&r));
+}
+
+void run_ecmult_multi_tests(void) {
+    secp256k1_scratch *scratch;
+    int i;
+
+    /* Without scratch space every term is multiplied on its own */
+    test_ecmult_multi(NULL);
+    for (i = 0; i < count; i++) {
+        /* Room for everything in one batch */
+        scratch = secp256k1_scratch_create(&ctx->error_callback, 1 << 20);
+        test_ecmult_multi(scratch);
+        secp256k1_scratch_destroy(scratch);
+    }
+    /* Space for a few points at a time, forcing several batches */
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_strauss_scratch_size(5) + STRAUSS_SCRATCH_OBJECTS * 16);
+    CHECK(secp256k1_strauss_max_points(scratch) == 5);
+    test_ecmult_multi(scratch);
+    secp256k1_scratch_destroy(scratch);
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_pippenger_scratch_size(40, 4) + PIPPENGER_SCRATCH_OBJECTS * 16);
+    CHECK(secp256k1_pippenger_max_points(scratch) > 0);
+    test_ecmult_multi(scratch);
+    secp256k1_scratch_destroy(scratch);
+    /* Too small for a single point */
+    scratch = secp256k1_scratch_create(&ctx->error_callback, 10);
+    CHECK(secp256k1_strauss_max_points(scratch) == 0);
+    CHECK(secp256k1_pippenger_max_points(scratch) == 0);
+    test_ecmult_multi(scratch);
+    secp256k1_scratch_destroy(scratch);
+
+    /* Frames nest and release in order */
+    scratch = secp256k1_scratch_create(&ctx->error_callback, 1000);
+    CHECK(secp256k1_scratch_max_allocation(scratch, 0) == 1000);
+    CHECK(secp256k1_scratch_allocate_frame(scratch, 500, 1));
+    CHECK(secp256k1_scratch_alloc(scratch, 500) != NULL);
+    CHECK(secp256k1_scratch_alloc(scratch, 16) == NULL);
+    CHECK(secp256k1_scratch_max_allocation(scratch, 0) == 1000 - 516);
+    CHECK(!secp256k1_scratch_allocate_frame(scratch, 500, 1));
+    CHECK(secp256k1_scratch_allocate_frame(scratch, 100, 1));
+    CHECK(secp256k1_scratch_alloc(scratch, 100) != NULL);
+    secp256k1_scratch_deallocate_frame(scratch);
+    secp256k1_scratch_deallocate_frame(scratch);
+    CHECK(secp256k1_scratch_max_allocation(scratch, 0) == 1000);
+    secp256k1_scratch_destroy(scratch);
+}
+
 void test_wnaf(const secp256k1_scalar *number, int w) {
     secp256k1_scalar x, two, t;
     int wnaf[256];
@@ -4459,6 +4603,10 @@ void run_ecdsa_openssl(void) {
 # include "modules/recovery/tests_impl.h"
 #endif
 
+#ifdef ENABLE_MODULE_SCHNORR
+# include "modules/schnorr/tests_impl.h"
+#endif
+
 #ifdef ENABLE_MODULE_GENERATOR
 # include "modules/generator/tests_impl.h"
 #endif
@@ -4565,6 +4713,7 @@ int main(int argc, char **argv) {
     run_ecmult_constants();
     run_ecmult_gen_blind();
     run_ecmult_const_tests();
+    run_ecmult_multi_tests();
     run_ec_combine();
 
     /* endomorphism tests */
@@ -4598,6 +4747,11 @@ int main(int argc, char **argv) {
     run_recovery_tests();
 #endif
 
+#ifdef ENABLE_MODULE_SCHNORR
+    /* Schnorr tests */
+    run_schnorr_tests();
+#endif
+
 #ifdef ENABLE_MODULE_GENERATOR
     run_generator_tests();
 #endif
@@ -411,6 +411,12 @@ public:
         clear();
     }
 
+    /** Exchange the whole underlying buffer, capacity included, with d and rewind */
+    void SwapStorage(CSerializeData &d) {
+        vch.swap(d);
+        nReadPos = 0;
+    }
+
     /**
      * XOR the contents of this stream with a certain key.
      *
@@ -0,0 +1,286 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <anon.h>
+#include <blind.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <key.h>
+#include <random.h>
+#include <rctindex.h>
+#include <streams.h>
+#include <test/test_bitcoin.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <validation.h>
+#include <version.h>
+
+#include <secp256k1_mlsag.h>
+#include <secp256k1_rangeproof.h>
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(anon_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(rct_last_output_at_height)
+{
+    // Every third block adds two anon outputs
+    std::vector<CBlockIndex> vBlocks(100);
+    int64_t nAnonOutputs = 0;
+    for (size_t i = 0; i < vBlocks.size(); i++) {
+        if (i % 3 == 0) {
+            nAnonOutputs += 2;
+        }
+        vBlocks[i].nHeight = i;
+        vBlocks[i].pprev = i ? &vBlocks[i - 1] : nullptr;
+        vBlocks[i].nAnonOutputs = nAnonOutputs;
+    }
+
+    CChain chain;
+    chain.SetTip(&vBlocks.back());
+
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, 0), 2);
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, 2), 2);
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, 3), 4);
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, 99), nAnonOutputs);
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, 1000), nAnonOutputs);
+    BOOST_CHECK_EQUAL(GetLastRCTOutputAtHeight(chain, -1), 0);
+
+    BOOST_CHECK_EQUAL(GetLastSpendableRCTOutput(chain, 0), nAnonOutputs);
+    BOOST_CHECK_EQUAL(GetLastSpendableRCTOutput(chain, 12), vBlocks[87].nAnonOutputs);
+    BOOST_CHECK_EQUAL(GetLastSpendableRCTOutput(chain, 100), 0);
+}
+
+BOOST_AUTO_TEST_CASE(rct_decoy_sampler)
+{
+    BOOST_CHECK_EQUAL(SampleRCTDecoy(0, 2400, 24000), 0);
+    BOOST_CHECK_EQUAL(SampleRCTDecoy(1, 2400, 24000), 1);
+
+    const int64_t nLastIndex = 100000;
+    int nRecent = 0;
+    for (int i = 0; i < 10000; i++) {
+        int64_t nDecoy = SampleRCTDecoy(nLastIndex, 2400, 24000);
+        BOOST_CHECK(nDecoy >= 1 && nDecoy <= nLastIndex);
+        if (nDecoy >= nLastIndex - 2400) {
+            nRecent++;
+        }
+    }
+    // Half the draws come from the last 2400 outputs, plus some from the wider groups
+    BOOST_CHECK(nRecent > 4500);
+}
+
+BOOST_AUTO_TEST_CASE(rct_output_points)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CPubKey pubkey = key.GetPubKey();
+    CCmpPubKey pk(pubkey.begin(), pubkey.end());
+    secp256k1_pedersen_commitment commitment;
+    memset(commitment.data, 0x08, 33);
+    COutPoint op(InsecureRand256(), 1);
+
+    // A record without points has the layout of version 0
+    CAnonOutput ao(pk, commitment, op, 10, 0);
+    BOOST_CHECK(!ao.HavePoints());
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << ao;
+    const size_t nSizeV0 = ss.size();
+    CAnonOutput aoRead;
+    ss >> aoRead;
+    BOOST_CHECK(!aoRead.HavePoints());
+    BOOST_CHECK(aoRead.pubkey == pk);
+    BOOST_CHECK(aoRead.outpoint == op);
+
+    BOOST_CHECK(ao.SetPoints());
+    BOOST_CHECK(ao.HavePoints());
+    // The decompressed x coordinate is the compressed key without its prefix
+    BOOST_CHECK(memcmp(ao.points.data, pk.begin() + 1, 32) == 0);
+
+    ss << ao;
+    BOOST_CHECK_EQUAL(ss.size(), nSizeV0 + 1 + CAnonOutputPoints::SIZE);
+    ss >> aoRead;
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK(aoRead.HavePoints());
+    BOOST_CHECK_EQUAL(aoRead.nBlockHeight, 10);
+    BOOST_CHECK(memcmp(ao.points.data, aoRead.points.data, CAnonOutputPoints::SIZE) == 0);
+
+    CAnonOutput aoInvalid;
+    BOOST_CHECK(!aoInvalid.SetPoints());
+    BOOST_CHECK(!aoInvalid.HavePoints());
+}
+
+BOOST_FIXTURE_TEST_CASE(rct_key_image_filter, TestingSetup)
+{
+    auto random_key_image = []() {
+        CKey key;
+        key.MakeNewKey(true);
+        CPubKey pubkey = key.GetPubKey();
+        return CCmpPubKey(pubkey.begin(), pubkey.end());
+    };
+
+    LOCK(cs_main);
+
+    // Key images in the DB when the filter is loaded are still read from the DB
+    CCmpPubKey kiLoaded = random_key_image();
+    uint256 txhashLoaded = InsecureRand256();
+    BOOST_CHECK(pblocktree->WriteRCTKeyImage(kiLoaded, txhashLoaded));
+    BOOST_CHECK(LoadKeyImageFilter(0));
+
+    uint256 txhash;
+    BOOST_CHECK(GetSpentKeyImage(kiLoaded, txhash));
+    BOOST_CHECK(txhash == txhashLoaded);
+    BOOST_CHECK(!GetSpentKeyImage(random_key_image(), txhash));
+
+    // FlushView adds the key images it writes to the filter
+    CCmpPubKey kiFlushed = random_key_image();
+    uint256 txhashFlushed = InsecureRand256();
+    CCoinsViewCache view(pcoinsTip.get());
+    view.keyImages.emplace_back(kiFlushed, txhashFlushed);
+    CValidationState state;
+    BOOST_CHECK(FlushView(&view, state, false));
+    BOOST_CHECK(view.keyImages.empty());
+    BOOST_CHECK(GetSpentKeyImage(kiFlushed, txhash));
+    BOOST_CHECK(txhash == txhashFlushed);
+    BOOST_CHECK(GetSpentKeyImage(kiLoaded, txhash));
+    BOOST_CHECK(txhash == txhashLoaded);
+}
+
+BOOST_FIXTURE_TEST_CASE(rct_proof_cache, TestingSetup)
+{
+    ECC_Start_Blinding();
+
+    uint8_t blind[32];
+    GetStrongRandBytes(blind, 32);
+    secp256k1_pedersen_commitment commitment;
+    BOOST_REQUIRE(secp256k1_pedersen_commit(secp256k1_ctx_blind, &commitment, blind, 5 * COIN, secp256k1_generator_h));
+    std::vector<uint8_t> vRangeproof(2000, 0xab);
+    BOOST_CHECK(!VerifyRangeproof(commitment, vRangeproof));
+
+    // An entry in the cache is taken as verified, even for an invalid proof
+    uint256 entry;
+    ProofCacheHasher('R').Write(commitment.data, 33).Write(vRangeproof.data(), vRangeproof.size()).Finalize(entry.begin());
+    ProofCacheAdd(entry);
+    BOOST_CHECK(VerifyRangeproof(commitment, vRangeproof));
+
+    // A changed commitment or proof byte misses
+    secp256k1_pedersen_commitment commitmentOther;
+    BOOST_REQUIRE(secp256k1_pedersen_commit(secp256k1_ctx_blind, &commitmentOther, blind, 6 * COIN, secp256k1_generator_h));
+    BOOST_CHECK(!VerifyRangeproof(commitmentOther, vRangeproof));
+    vRangeproof[1000] ^= 1;
+    BOOST_CHECK(!VerifyRangeproof(commitment, vRangeproof));
+    vRangeproof[1000] ^= 1;
+
+    // A ring of three anon outputs, the input spends the second
+    const size_t nCols = 3, nRows = 2, nSecretColumn = 1;
+    CAmount nValue = 10 * COIN, nFee = COIN / 100;
+    std::vector<CKey> vKeys(nCols);
+    std::vector<uint8_t> vBlinds(nCols * 32);
+    std::vector<CAnonOutput> vRing(nCols);
+    for (size_t i = 0; i < nCols; ++i) {
+        vKeys[i].MakeNewKey(true);
+        CPubKey pubkey = vKeys[i].GetPubKey();
+        GetStrongRandBytes(&vBlinds[i * 32], 32);
+        secp256k1_pedersen_commitment c;
+        BOOST_REQUIRE(secp256k1_pedersen_commit(secp256k1_ctx_blind, &c, &vBlinds[i * 32], nValue, secp256k1_generator_h));
+        COutPoint op(InsecureRand256(), 0);
+        vRing[i] = CAnonOutput(CCmpPubKey(pubkey.begin(), pubkey.end()), c, op, 1, 0);
+        BOOST_CHECK(vRing[i].SetPoints());
+        BOOST_CHECK(pblocktree->WriteRCTOutput(i + 1, vRing[i]));
+    }
+
+    CMutableTransaction mtx;
+    mtx.nVersion = GLOBE_TXN_VERSION;
+    mtx.SetType(TXN_STANDARD);
+    mtx.vin.resize(1);
+    mtx.vin[0].SetAnonInfo(1, nCols);
+    auto out_fee = MAKE_OUTPUT<CTxOutData>();
+    out_fee->SetCTFee(nFee);
+    auto out_standard = MAKE_OUTPUT<CTxOutStandard>();
+    out_standard->nValue = nValue - nFee;
+    out_standard->scriptPubKey << OP_TRUE;
+    mtx.vpout = {out_fee, out_standard};
+
+    std::vector<uint8_t> vMI;
+    for (size_t i = 0; i < nCols; ++i) {
+        PutVarInt(vMI, i + 1);
+    }
+    std::vector<uint8_t> vKeyImage(33);
+    BOOST_REQUIRE(0 == secp256k1_get_keyimage(secp256k1_ctx_blind, &vKeyImage[0], vRing[nSecretColumn].pubkey.begin(), vKeys[nSecretColumn].begin()));
+    mtx.vin[0].scriptData.stack.push_back(vKeyImage);
+    mtx.vin[0].scriptWitness.stack.push_back(vMI);
+    mtx.vin[0].scriptWitness.stack.push_back(std::vector<uint8_t>((1 + nRows * nCols) * 32));
+
+    // Sign as the wallet does, the plain output value is committed to with a zero blind
+    std::vector<uint8_t> vM(nCols * nRows * 33);
+    std::vector<const uint8_t*> vpInCommits(nCols);
+    for (size_t i = 0; i < nCols; ++i) {
+        memcpy(&vM[i * 33], vRing[i].pubkey.begin(), 33);
+        vpInCommits[i] = vRing[i].commitment.data;
+    }
+    uint8_t zeroBlind[32] = {0};
+    secp256k1_pedersen_commitment plainCommitment;
+    BOOST_REQUIRE(secp256k1_pedersen_commit(secp256k1_ctx_blind, &plainCommitment, zeroBlind, nValue, secp256k1_generator_h));
+    std::vector<const uint8_t*> vpOutCommits{plainCommitment.data};
+    std::vector<const uint8_t*> vpBlinds{&vBlinds[nSecretColumn * 32], zeroBlind};
+    uint8_t blindSum[32] = {0};
+    BOOST_REQUIRE(0 == secp256k1_prepare_mlsag(&vM[0], blindSum, 1, 1, nCols, nRows, &vpInCommits[0], &vpOutCommits[0], &vpBlinds[0]));
+    const uint8_t *vpsk[nRows] = {vKeys[nSecretColumn].begin(), blindSum};
+    uint8_t randSeed[32];
+    GetStrongRandBytes(randSeed, 32);
+    uint256 txhash = mtx.GetHash();
+    std::vector<uint8_t> &vDL = mtx.vin[0].scriptWitness.stack[1];
+    BOOST_REQUIRE(0 == secp256k1_generate_mlsag(secp256k1_ctx_blind, &mtx.vin[0].scriptData.stack[0][0], &vDL[0], &vDL[32],
+        randSeed, txhash.begin(), nCols, nRows, nSecretColumn, vpsk, &vM[0]));
+
+    CTransaction tx(mtx);
+    CValidationState state;
+    BOOST_CHECK(VerifyMLSAG(tx, state, false));
+    BOOST_CHECK(VerifyMLSAG(tx, state, false));
+
+    // Without fCheckKeyImages the mempool and the chain are not asked for the key images
+    CCmpPubKey ki(vKeyImage.begin(), vKeyImage.end());
+    {
+        LOCK(mempool.cs);
+        mempool.mapKeyImages[ki] = InsecureRand256();
+    }
+    BOOST_CHECK(VerifyMLSAG(tx, state, false));
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!VerifyMLSAG(tx, state, true));
+        BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-anonin-dup-ki");
+    }
+    {
+        LOCK(mempool.cs);
+        mempool.mapKeyImages.erase(ki);
+    }
+
+    // An index reused for another output after a disconnect misses the cache
+    CKey keyOther;
+    keyOther.MakeNewKey(true);
+    CPubKey pubkeyOther = keyOther.GetPubKey();
+    CAnonOutput aoOther(CCmpPubKey(pubkeyOther.begin(), pubkeyOther.end()), vRing[0].commitment, vRing[0].outpoint, 2, 0);
+    BOOST_CHECK(aoOther.SetPoints());
+    BOOST_CHECK(pblocktree->WriteRCTOutput(1, aoOther));
+    CValidationState stateRing;
+    BOOST_CHECK(!VerifyMLSAG(tx, stateRing, false));
+    BOOST_CHECK_EQUAL(stateRing.GetRejectReason(), "verify-mlsag-failed");
+    BOOST_CHECK(pblocktree->WriteRCTOutput(1, vRing[0]));
+    BOOST_CHECK(VerifyMLSAG(tx, state, false));
+
+    // So does a changed key image
+    CMutableTransaction mtxOther(tx);
+    CKey keyImageOther;
+    keyImageOther.MakeNewKey(true);
+    CPubKey pubkeyImageOther = keyImageOther.GetPubKey();
+    mtxOther.vin[0].scriptData.stack[0].assign(pubkeyImageOther.begin(), pubkeyImageOther.end());
+    CValidationState stateKI;
+    BOOST_CHECK(!VerifyMLSAG(CTransaction(mtxOther), stateKI, false));
+    BOOST_CHECK_EQUAL(stateKI.GetRejectReason(), "verify-mlsag-failed");
+
+    ECC_Stop_Blinding();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
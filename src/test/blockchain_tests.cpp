@@ -75,4 +75,61 @@ BOOST_AUTO_TEST_CASE(get_difficulty_for_null_tip)
     RejectDifficultyMismatch(difficulty, 1.0);
 }
 
+BOOST_AUTO_TEST_CASE(block_sig_store)
+{
+    CBlockSigStore store;
+    CBlockIndex index_a, index_b;
+    const std::vector<unsigned char> sig_a(72, 0xaa);
+    std::vector<unsigned char> sig;
+
+    // Nothing held and no reader
+    BOOST_CHECK(!store.Get(&index_a, sig));
+
+    store.Add(&index_a, sig_a);
+    store.Add(&index_b, std::vector<unsigned char>()); // proof-of-work, not held
+    BOOST_CHECK_EQUAL(store.Size(), 1U);
+    BOOST_CHECK(store.DynamicMemoryUsage() > 0);
+    BOOST_CHECK(store.Get(&index_a, sig));
+    BOOST_CHECK(sig == sig_a);
+
+    // Released entries are read back through the reader
+    int reads = 0;
+    store.SetReader([&reads](const CBlockIndex*, std::vector<unsigned char>& vchBlockSig) {
+        reads++;
+        vchBlockSig.assign(72, 0xbb);
+        return true;
+    });
+    BOOST_CHECK(store.Get(&index_a, sig));
+    BOOST_CHECK(sig == sig_a);
+    BOOST_CHECK_EQUAL(reads, 0);
+
+    // Released entries stay among the recent ones
+    store.Release(&index_a);
+    BOOST_CHECK_EQUAL(store.Size(), 0U);
+    BOOST_CHECK(store.Get(&index_a, sig));
+    BOOST_CHECK(sig == sig_a);
+    BOOST_CHECK_EQUAL(reads, 0);
+
+    // Others are read back once through the reader
+    BOOST_CHECK(store.Get(&index_b, sig));
+    BOOST_CHECK(sig == std::vector<unsigned char>(72, 0xbb));
+    BOOST_CHECK(store.Get(&index_b, sig));
+    BOOST_CHECK_EQUAL(reads, 1);
+
+    // The oldest recent entries are evicted
+    std::vector<CBlockIndex> vIndex(MAX_RECENT_BLOCK_SIGS);
+    for (const CBlockIndex& index : vIndex) {
+        BOOST_CHECK(store.Get(&index, sig));
+    }
+    BOOST_CHECK_EQUAL(reads, 1 + (int)MAX_RECENT_BLOCK_SIGS);
+    BOOST_CHECK(store.Get(&index_a, sig));
+    BOOST_CHECK(sig == std::vector<unsigned char>(72, 0xbb));
+    BOOST_CHECK_EQUAL(reads, 2 + (int)MAX_RECENT_BLOCK_SIGS);
+
+    // A failed read is reported
+    store.SetReader([](const CBlockIndex*, std::vector<unsigned char>&) { return false; });
+    BOOST_CHECK(!store.Get(&vIndex[0], sig));
+    BOOST_CHECK(store.Get(&vIndex[MAX_RECENT_BLOCK_SIGS - 1], sig));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
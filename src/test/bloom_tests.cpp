@@ -533,4 +533,34 @@ BOOST_AUTO_TEST_CASE(rolling_bloom)
     }
 }
 
+BOOST_AUTO_TEST_CASE(blocked_bloom)
+{
+    CBlockedBloomFilter bf(1000);
+
+    static const int DATASIZE=1000;
+    std::vector<unsigned char> data[DATASIZE];
+    for (int i = 0; i < DATASIZE; i++) {
+        BOOST_CHECK(!bf.IsFull());
+        data[i] = RandomData();
+        bf.insert(data[i].data(), data[i].size());
+    }
+    BOOST_CHECK(bf.IsFull());
+    BOOST_CHECK_EQUAL(bf.size(), (unsigned int)DATASIZE);
+
+    // Never a false negative:
+    for (int i = 0; i < DATASIZE; i++) {
+        BOOST_CHECK(bf.contains(data[i].data(), data[i].size()));
+    }
+
+    // About 0.1% false positives, so about 10 hits for 10,000 random keys:
+    unsigned int nHits = 0;
+    for (int i = 0; i < 10000; i++) {
+        std::vector<unsigned char> d = RandomData();
+        if (bf.contains(d.data(), d.size()))
+            ++nHits;
+    }
+    BOOST_TEST_MESSAGE("BlockedBloomFilter got " << nHits << " false positives (~10 expected)");
+    BOOST_CHECK(nHits < 50);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
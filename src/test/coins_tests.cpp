@@ -588,7 +588,8 @@ void GetCoinsMapEntry(const CCoinsMap& map, CAmount& value, char& flags)
 
 void WriteCoinsViewEntry(CCoinsView& view, CAmount value, char flags)
 {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map(0, SaltedOutpointHasher(), CCoinsMap::key_equal(), &resource);
     InsertCoinsMapEntry(map, value, flags);
     view.BatchWrite(map, {});
 }
@@ -857,5 +858,79 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_commitment)
+{
+    Coin coin;
+    BOOST_CHECK(coin.commitment.IsNull());
+    BOOST_CHECK_EQUAL(coin.DynamicMemoryUsage(), 0U);
+
+    secp256k1_pedersen_commitment commitment;
+    memset(commitment.data, 0x09, sizeof(commitment.data));
+    coin.out.scriptPubKey = CScript() << OP_TRUE;
+    coin.nType = OUTPUT_CT;
+    coin.commitment.Set() = commitment;
+    BOOST_CHECK(coin.DynamicMemoryUsage() > 0);
+
+    // Copies own their commitment
+    Coin copy = coin;
+    coin.commitment.Set().data[0] = 0x08;
+    BOOST_CHECK(memcmp(copy.commitment.Get().data, commitment.data, 33) == 0);
+
+    // Round trips through the coins db encoding
+    bool fGlobeModeBefore = fGlobeMode;
+    fGlobeMode = true;
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << copy;
+    Coin decoded;
+    ss >> decoded;
+    fGlobeMode = fGlobeModeBefore;
+    BOOST_CHECK_EQUAL(decoded.nType, OUTPUT_CT);
+    BOOST_CHECK(memcmp(decoded.commitment.Get().data, commitment.data, 33) == 0);
+
+    // Spending frees it, keeping cachedCoinsUsage consistent
+    coin.Clear();
+    BOOST_CHECK(coin.commitment.IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_pool_resource)
+{
+    PoolResource<64, 8> resource(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // Freed blocks are reused by the next allocation of the same size
+    void* a = resource.Allocate(24, 8);
+    void* b = resource.Allocate(24, 8);
+    BOOST_CHECK(a != b);
+    resource.Deallocate(a, 24, 8);
+    BOOST_CHECK_EQUAL(resource.Allocate(24, 8), a);
+
+    // Oversized requests bypass the pool
+    void* big = resource.Allocate(128, 8);
+    resource.Deallocate(big, 128, 8);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; i++)
+        blocks.push_back(resource.Allocate(64, 8));
+    BOOST_CHECK(resource.NumAllocatedChunks() > 1);
+    for (void* p : blocks)
+        resource.Deallocate(p, 64, 8);
+
+    // The cache map accounts for the chunks it holds, and releases them on flush
+    CCoinsView root;
+    CCoinsViewCacheTest base(&root);
+    CCoinsViewCacheTest cache(&base);
+    size_t nEmptyUsage = cache.DynamicMemoryUsage();
+    for (uint32_t i = 0; i < 10000; i++) {
+        Coin coin;
+        coin.out.nValue = i + 1;
+        coin.out.scriptPubKey = CScript() << OP_TRUE;
+        cache.AddCoin(COutPoint(InsecureRand256(), i), std::move(coin), false);
+    }
+    BOOST_CHECK(cache.DynamicMemoryUsage() > nEmptyUsage);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage(), nEmptyUsage);
+    BOOST_CHECK_EQUAL(base.GetCacheSize(), 10000U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
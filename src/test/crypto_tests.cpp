@@ -562,4 +562,32 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256d_multi)
+{
+    // Cover every padding case, and batches of every size up to a few rounds of lanes.
+    for (int count = 0; count <= 40; ++count) {
+        std::vector<std::vector<unsigned char>> msgs(count);
+        std::vector<const unsigned char*> inputs;
+        std::vector<size_t> lens;
+        for (auto& msg : msgs) {
+            msg.resize(InsecureRandRange(count % 2 ? 300 : 130));
+            for (auto& c : msg) c = InsecureRandBits(8);
+            inputs.push_back(msg.data());
+            lens.push_back(msg.size());
+        }
+        std::vector<unsigned char> out1(32 * count), out2(32 * count);
+        for (int i = 0; i < count; ++i) {
+            CHash256().Write(inputs[i], lens[i]).Finalize(out1.data() + 32 * i);
+        }
+        SHA256DMulti(out2.data(), inputs.data(), lens.data(), count);
+        BOOST_CHECK(out1 == out2);
+
+        std::vector<uint256> hashes = SerializeHashes(msgs);
+        BOOST_REQUIRE_EQUAL(hashes.size(), msgs.size());
+        for (int i = 0; i < count; ++i) {
+            BOOST_CHECK(hashes[i] == SerializeHash(msgs[i]));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <script/sigcache.h>
 #include <test/test_bitcoin.h>
 #include <random.h>
+#include <set>
 #include <thread>
 
 /** Test Suite for CuckooCache
@@ -377,4 +378,40 @@ BOOST_AUTO_TEST_CASE(cuckoocache_generations)
     test_cache_generations<CuckooCache::cache<uint256, SignatureCacheHasher>>();
 }
 
+/* Test that for_each visits every element which is neither erased nor
+ * evicted, and that reinserting them into a fresh cache (as is done when
+ * loading a saved cache) gives a cache with the same contents.
+ */
+BOOST_AUTO_TEST_CASE(cuckoocache_for_each)
+{
+    local_rand_ctx = FastRandomContext(true);
+    CuckooCache::cache<uint256, SignatureCacheHasher> cc{};
+    cc.setup_bytes(1 << 20);
+    std::vector<uint256> hashes(10000);
+    for (uint256& h : hashes) {
+        insecure_GetRandHash(h);
+        cc.insert(h);
+    }
+    for (size_t i = 0; i < hashes.size(); i += 2) {
+        cc.contains(hashes[i], true);
+    }
+
+    std::set<uint256> visited;
+    cc.for_each([&visited](const uint256& h) { visited.insert(h); });
+    size_t kept = 0;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        BOOST_CHECK(!visited.count(hashes[i]) || (i % 2 == 1 && cc.contains(hashes[i], false)));
+        kept += visited.count(hashes[i]);
+    }
+    BOOST_CHECK_EQUAL(kept, visited.size());
+    BOOST_CHECK_EQUAL(kept, hashes.size() / 2);
+
+    CuckooCache::cache<uint256, SignatureCacheHasher> reloaded{};
+    reloaded.setup_bytes(1 << 20);
+    cc.for_each([&reloaded](const uint256& h) { reloaded.insert(h); });
+    for (size_t i = 1; i < hashes.size(); i += 2) {
+        BOOST_CHECK(reloaded.contains(hashes[i], false));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
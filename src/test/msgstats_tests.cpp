@@ -0,0 +1,62 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <msgstats.h>
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(msgstats_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(latency_histogram)
+{
+    LatencyHistogram hist;
+    BOOST_CHECK_EQUAL(hist.Count(), 0U);
+    BOOST_CHECK_EQUAL(hist.Quantile(0.5), 0);
+
+    // Bucket i holds latencies below 2^i microseconds
+    hist.Add(0);
+    hist.Add(1);
+    hist.Add(3);
+    hist.Add(4);
+    hist.Add(-5); // clock went backwards, counted as 0
+    BOOST_CHECK_EQUAL(hist.Buckets()[0], 2U);
+    BOOST_CHECK_EQUAL(hist.Buckets()[1], 1U);
+    BOOST_CHECK_EQUAL(hist.Buckets()[2], 1U);
+    BOOST_CHECK_EQUAL(hist.Buckets()[3], 1U);
+    BOOST_CHECK_EQUAL(hist.Count(), 5U);
+    BOOST_CHECK_EQUAL(hist.TotalMicros(), 8);
+    BOOST_CHECK_EQUAL(hist.MaxMicros(), 4);
+
+    // Quantiles report the bucket bound, capped at the slowest latency seen
+    BOOST_CHECK_EQUAL(hist.Quantile(0.4), 1);
+    BOOST_CHECK_EQUAL(hist.Quantile(0.6), 2);
+    BOOST_CHECK_EQUAL(hist.Quantile(1.0), 4);
+
+    // Anything past the last bound lands in the unbounded bucket
+    hist.Add(int64_t{1} << 40);
+    BOOST_CHECK_EQUAL(hist.Buckets()[LatencyHistogram::BUCKETS - 1], 1U);
+    BOOST_CHECK_EQUAL(LatencyHistogram::BucketBound(LatencyHistogram::BUCKETS - 1), 0);
+    BOOST_CHECK_EQUAL(hist.Quantile(1.0), int64_t{1} << 40);
+}
+
+BOOST_AUTO_TEST_CASE(msgstats_stages)
+{
+    CMsgStats stats;
+    stats.RecordMessage("tx", 10);
+    stats.RecordMessage("tx", 20);
+    stats.RecordStage(ValidationStage::VERIFY_MLSAG, 100);
+
+    mapMsgCmdLatency messages = stats.GetMessages();
+    BOOST_CHECK_EQUAL(messages.size(), 1U);
+    BOOST_CHECK_EQUAL(messages["tx"].Count(), 2U);
+    BOOST_CHECK_EQUAL(messages["tx"].TotalMicros(), 30);
+
+    std::map<std::string, LatencyHistogram> stages = stats.GetStages();
+    BOOST_CHECK_EQUAL(stages.size(), VALIDATION_STAGE_COUNT);
+    BOOST_CHECK_EQUAL(stages["verifymlsag"].Count(), 1U);
+    BOOST_CHECK_EQUAL(stages["processnewblock"].Count(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -189,4 +189,88 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+BOOST_AUTO_TEST_CASE(socketevents_mode)
+{
+    SocketEventsMode mode = SocketEventsMode::EPOLL;
+    BOOST_CHECK(ParseSocketEventsMode("select", mode));
+    BOOST_CHECK(mode == SocketEventsMode::SELECT);
+    BOOST_CHECK(!ParseSocketEventsMode("poll", mode));
+    BOOST_CHECK(!ParseSocketEventsMode("", mode));
+    BOOST_CHECK(mode == SocketEventsMode::SELECT);
+
+    // The default must always be usable on this platform
+    BOOST_CHECK(ParseSocketEventsMode(DEFAULT_SOCKETEVENTS, mode));
+}
+
+BOOST_AUTO_TEST_CASE(recv_buffer_pool)
+{
+    CNetRecvBufferPool pool(1024 * 1024);
+    CSerializeData buf;
+    BOOST_CHECK(!pool.Get(300000, buf));
+
+    // Small buffers are not kept
+    buf.resize(1000);
+    pool.Put(buf);
+    BOOST_CHECK_EQUAL(pool.FreeBytes(), 0U);
+
+    buf.resize(400000);
+    size_t nCapacity = buf.capacity();
+    pool.Put(buf);
+    BOOST_CHECK(buf.empty());
+    BOOST_CHECK_EQUAL(pool.FreeBytes(), nCapacity);
+
+    BOOST_CHECK(!pool.Get(nCapacity + 1, buf));
+    BOOST_CHECK(pool.Get(300000, buf));
+    BOOST_CHECK_EQUAL(buf.capacity(), nCapacity);
+    BOOST_CHECK_EQUAL(pool.FreeBytes(), 0U);
+
+    // Nothing is kept beyond the limit
+    CSerializeData big(2 * 1024 * 1024);
+    pool.Put(big);
+    BOOST_CHECK_EQUAL(pool.FreeBytes(), 0U);
+    pool.Put(buf);
+    pool.SetMaxBytes(0);
+    BOOST_CHECK_EQUAL(pool.FreeBytes(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(recv_message_pooled)
+{
+    CNetRecvBufferPool pool(4 * 1024 * 1024);
+    CSerializeData seed(1024 * 1024);
+    pool.Put(seed);
+
+    std::vector<unsigned char> payload(CNetRecvBufferPool::MIN_BUFFER_SIZE + 12345);
+    for (unsigned char& c : payload)
+        c = InsecureRand32();
+    uint256 hash = Hash(payload.begin(), payload.end());
+
+    CMessageHeader hdr(Params().MessageStart(), NetMsgType::BLOCK, payload.size());
+    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    CDataStream wire(SER_NETWORK, INIT_PROTO_VERSION);
+    wire << hdr;
+    wire.write((const char*)payload.data(), payload.size());
+
+    {
+        CNetMessage msg(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION, &pool);
+        const char* pch = wire.data();
+        unsigned int nBytes = wire.size();
+        while (nBytes > 0) {
+            // Feed the message in socket sized pieces
+            unsigned int nChunk = std::min(nBytes, 1000U);
+            int handled = msg.in_data ? msg.readData(pch, nChunk) : msg.readHeader(pch, nChunk);
+            BOOST_REQUIRE(handled > 0);
+            pch += handled;
+            nBytes -= handled;
+        }
+        BOOST_CHECK(msg.complete());
+        // The payload went into the pooled buffer
+        BOOST_CHECK_EQUAL(pool.FreeBytes(), 0U);
+        BOOST_CHECK(msg.vRecv.size() == payload.size());
+        BOOST_CHECK(memcmp(msg.vRecv.data(), payload.data(), payload.size()) == 0);
+        BOOST_CHECK(msg.GetMessageHash() == hash);
+    }
+    // and is returned once the message is gone
+    BOOST_CHECK(pool.FreeBytes() >= 1024 * 1024);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -77,12 +77,37 @@ std::vector<valtype> CODE =
     valtype(ParseHex("6060604052734de45add9f5f0b6887081cfcfe3aca6da9eb3365600060006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff1602179055505b5b5b60b68061006a6000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff16806341c0e1b5146045575b60435b5b565b005b604b604d565b005b600060009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16ff5b5600a165627a7a72305820e296f585c72ea3d4dce6880122cfe387d26c48b7960676a52e811b56ef8297a80029"))
 };
 
+void checkAccountWalk(const std::unordered_map<dev::Address, dev::u256>& addresses){
+    std::vector<std::pair<dev::h256, dev::Address>> walked;
+    globalState->forEachAccount(dev::h256(), [&](const dev::h256& hashed, const dev::Address& address){
+        walked.emplace_back(hashed, address);
+        return true;
+    });
+    BOOST_CHECK(walked.size() == addresses.size());
+    for(size_t i = 0; i < walked.size(); i++){
+        BOOST_CHECK(addresses.count(walked[i].second));
+        BOOST_CHECK(walked[i].first == dev::sha3(walked[i].second));
+        if(i > 0)
+            BOOST_CHECK(walked[i - 1].first < walked[i].first);
+    }
+    if(walked.size() > 1){
+        std::vector<dev::Address> resumed;
+        globalState->forEachAccount(walked[1].first, [&](const dev::h256& hashed, const dev::Address& address){
+            resumed.push_back(address);
+            return resumed.size() < 2;
+        });
+        BOOST_CHECK(resumed.size() == std::min<size_t>(2, walked.size() - 1));
+        BOOST_CHECK(resumed[0] == walked[1].second);
+    }
+}
+
 void checkExecResult(std::vector<ResultExecute>& result, size_t execResSize, size_t addressesSize, 
                      dev::eth::TransactionException except, std::vector<dev::Address> newAddresses, 
                      valtype output, dev::u256 balance, bool normalAndIncorrect = false){
     std::unordered_map<dev::Address, dev::u256> addresses = globalState->addresses();
     BOOST_CHECK(result.size() == execResSize);
     BOOST_CHECK(addresses.size() == addressesSize);
+    checkAccountWalk(addresses);
     for(size_t i = 0; i < result.size(); i++){
         if(normalAndIncorrect){
             if(i%2 == 0){
@@ -4,6 +4,7 @@
 
 #include <test/test_bitcoin.h>
 
+#include <blind.h>
 #include <chainparams.h>
 #include <consensus/consensus.h>
 #include <consensus/validation.h>
@@ -55,6 +56,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
     SetupNetworking();
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitProofCache();
     fCheckBlockIndex = true;
     SelectParams(chainName);
     noui_connect();
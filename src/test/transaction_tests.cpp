@@ -423,6 +423,72 @@ static void ReplaceRedeemScript(CScript& script, const CScript& redeemScript)
     script = PushAll(stack);
 }
 
+static void CheckDeserializedHashes(const CMutableTransaction& mtx)
+{
+    for (int nVersion : {PROTOCOL_VERSION, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS}) {
+        CDataStream ss(SER_NETWORK, nVersion);
+        ss << mtx;
+        CMutableTransaction mtx_read(deserialize, ss);
+        ss << mtx;
+        CTransaction tx(deserialize, ss);
+        BOOST_CHECK(ss.empty());
+        BOOST_CHECK_EQUAL(tx.GetHash(), mtx_read.GetHash());
+        uint256 witness_hash = mtx_read.HasWitness() ? SerializeHash(mtx_read, SER_GETHASH, 0) : mtx_read.GetHash();
+        BOOST_CHECK_EQUAL(tx.GetWitnessHash(), witness_hash);
+        BOOST_CHECK(tx.GetHash() == CTransaction(mtx_read).GetHash());
+        BOOST_CHECK(tx.GetWitnessHash() == CTransaction(mtx_read).GetWitnessHash());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(deserialize_hashes)
+{
+    // Globe transaction with every output type; range proofs are not part of the txid
+    CMutableTransaction mtx;
+    mtx.nVersion = GLOBE_TXN_VERSION;
+    mtx.SetType(TXN_STANDARD);
+    mtx.nLockTime = 1234;
+    mtx.vin.resize(2);
+    mtx.vin[0].prevout = COutPoint(InsecureRand256(), 1);
+    mtx.vin[0].scriptSig << OP_1;
+    mtx.vin[1].prevout = COutPoint(InsecureRand256(), 2);
+
+    auto out_standard = MAKE_OUTPUT<CTxOutStandard>();
+    out_standard->nValue = 5 * COIN;
+    out_standard->scriptPubKey << OP_TRUE;
+    auto out_ct = MAKE_OUTPUT<CTxOutCT>();
+    memset(out_ct->commitment.data, 0x08, 33);
+    out_ct->vData.assign(33, 0x02);
+    out_ct->scriptPubKey << OP_TRUE;
+    out_ct->vRangeproof.assign(5000, 0xab);
+    auto out_ringct = MAKE_OUTPUT<CTxOutRingCT>();
+    memset(out_ringct->commitment.data, 0x09, 33);
+    out_ringct->vData.assign(33, 0x03);
+    out_ringct->vRangeproof.assign(3000, 0xcd);
+    auto out_data = MAKE_OUTPUT<CTxOutData>();
+    out_data->vData.assign(10, 0x01);
+    mtx.vpout = {out_data, out_standard, out_ct, out_ringct};
+    CheckDeserializedHashes(mtx);
+
+    mtx.vin[1].scriptWitness.stack.push_back(std::vector<unsigned char>(72, 0x30));
+    mtx.vin[1].scriptWitness.stack.push_back(std::vector<unsigned char>(33, 0x02));
+    CheckDeserializedHashes(mtx);
+
+    out_ct->vRangeproof.clear();
+    CheckDeserializedHashes(mtx);
+
+    // Legacy transactions, in the basic format and in the extended witness format
+    CMutableTransaction mtx_legacy;
+    mtx_legacy.nVersion = 2;
+    mtx_legacy.vin.resize(1);
+    mtx_legacy.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    mtx_legacy.vout.resize(2);
+    mtx_legacy.vout[0].nValue = COIN;
+    mtx_legacy.vout[0].scriptPubKey << OP_TRUE;
+    CheckDeserializedHashes(mtx_legacy);
+    mtx_legacy.vin[0].scriptWitness.stack.push_back(std::vector<unsigned char>(10, 0x01));
+    CheckDeserializedHashes(mtx_legacy);
+}
+
 BOOST_AUTO_TEST_CASE(test_big_witness_transaction) {
     CMutableTransaction mtx;
     mtx.nVersion = 1;
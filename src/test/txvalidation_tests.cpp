@@ -5,6 +5,7 @@
 #include <validation.h>
 #include <txmempool.h>
 #include <amount.h>
+#include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <primitives/transaction.h>
 #include <script/script.h>
@@ -58,4 +59,43 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_coinbase, TestChain100Setup)
     BOOST_CHECK_EQUAL(nDoS, 100);
 }
 
+/**
+ * Ensure that pre-validation only rejects what CheckTransaction rejects, the
+ * other checks are left to AcceptToMemoryPool.
+ */
+BOOST_FIXTURE_TEST_CASE(tx_prevalidate_verdict, TestChain100Setup)
+{
+    CMutableTransaction spendTx;
+    spendTx.nVersion = 1;
+    spendTx.vin.resize(1);
+    spendTx.vin[0].prevout = COutPoint(m_coinbase_txns[0]->GetHash(), 0);
+    spendTx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(71, 0x30);
+    spendTx.vout.resize(1);
+    spendTx.vout[0].nValue = 1 * CENT;
+    spendTx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+
+    // The signature is invalid, which only AcceptToMemoryPool reports
+    CValidationState state;
+    BOOST_CHECK(PreValidateTransaction(CTransaction(spendTx), state));
+    BOOST_CHECK(state.IsValid());
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!AcceptToMemoryPool(mempool, state, MakeTransactionRef(spendTx),
+                nullptr /* pfMissingInputs */,
+                nullptr /* plTxnReplaced */,
+                true /* bypass_limits */,
+                0 /* nAbsurdFee */));
+        BOOST_CHECK(state.IsInvalid());
+    }
+
+    // A malformed transaction is rejected as CheckTransaction rejects it
+    spendTx.vin.push_back(spendTx.vin[0]);
+    CValidationState stateCheck;
+    BOOST_CHECK(!CheckTransaction(CTransaction(spendTx), stateCheck));
+    CValidationState statePreValid;
+    BOOST_CHECK(!PreValidateTransaction(CTransaction(spendTx), statePreValid));
+    BOOST_CHECK_EQUAL(statePreValid.GetRejectReason(), stateCheck.GetRejectReason());
+    BOOST_CHECK_EQUAL(statePreValid.GetRejectReason(), "bad-txns-inputs-duplicate");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,11 @@
 #include <policy/policy.h>
 #include <globe/stealth.h>
 #include <globe/extkey.h>
+#include <clientversion.h>
+#include <crypto/common.h>
+#include <fs.h>
+#include <hash.h>
+#include <script/sigcache.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -388,4 +393,48 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(sigcache_dump_load, TestingSetup)
+{
+    auto have_entry = [](const uint256& entry) {
+        bool found = false;
+        ForEachSignatureCacheEntry([&](const uint256& e) { found |= e == entry; });
+        return found;
+    };
+
+    const uint256 nonce = GetSignatureCacheNonce();
+    const uint256 entry = InsecureRand256();
+    AddSignatureCacheEntry(entry);
+    BOOST_CHECK(DumpSigCaches());
+
+    // Loading into an emptied cache brings back the entry and its nonce
+    InitSignatureCache();
+    SetSignatureCacheNonce(InsecureRand256());
+    BOOST_CHECK(!have_entry(entry));
+    BOOST_CHECK(LoadSigCaches());
+    BOOST_CHECK(GetSignatureCacheNonce() == nonce);
+    BOOST_CHECK(have_entry(entry));
+
+    // Rewrite the client version, which follows the network magic and the
+    // file version, and the hash over the contents
+    fs::path path = GetDataDir() / "sigcache.dat";
+    std::vector<unsigned char> data(fs::file_size(path));
+    FILE* file = fsbridge::fopen(path, "rb");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE_EQUAL(fread(data.data(), 1, data.size(), file), data.size());
+    fclose(file);
+    BOOST_REQUIRE_EQUAL(ReadLE32(&data[12]), (uint32_t)CLIENT_VERSION);
+    WriteLE32(&data[12], CLIENT_VERSION + 1);
+    uint256 hash = Hash(data.begin(), data.end() - 32);
+    std::copy(hash.begin(), hash.end(), data.end() - 32);
+    file = fsbridge::fopen(path, "wb");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE_EQUAL(fwrite(data.data(), 1, data.size(), file), data.size());
+    fclose(file);
+
+    // A file written by another client version is discarded
+    InitSignatureCache();
+    BOOST_CHECK(!LoadSigCaches());
+    BOOST_CHECK(!have_entry(entry));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
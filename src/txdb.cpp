@@ -14,7 +14,9 @@
 #include <util.h>
 #include <ui_interface.h>
 
+#include <algorithm>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/thread.hpp>
 
@@ -430,69 +432,179 @@ bool CBlockTreeDB::EraseStakeIndex(unsigned int height) {
 }
 ///////////////////////////////////////////////////////
 
-bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+namespace {
+
+/** A block index entry decoded by a loader thread, not yet linked into mapBlockIndex */
+struct LoadedBlockIndex
 {
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    uint256 hash;
+    uint256 hashPrev;
+    CBlockIndex* pindex;
+};
+
+/**
+ * Decode all DB_BLOCK_INDEX entries whose first key byte is in [nBegin, nEnd).
+ * Entries are allocated here so the serial pass only has to link them.
+ */
+bool LoadBlockIndexRange(CBlockTreeDB& db, const Consensus::Params& consensusParams, int nBegin, int nEnd, std::vector<LoadedBlockIndex>& vLoaded)
+{
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
 
-    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
+    uint256 hashStart;
+    *hashStart.begin() = nBegin;
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, hashStart));
 
-    // Load mapBlockIndex
     while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
+        if (ShutdownRequested())
+            return false;
         std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nMoneySupply   = diskindex.nMoneySupply;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                pindexNew->hashStateRoot  = diskindex.hashStateRoot; // qtum
-                pindexNew->hashUTXORoot   = diskindex.hashUTXORoot; // qtum
-                pindexNew->nStakeModifier = diskindex.nStakeModifier;
-                pindexNew->prevoutStake   = diskindex.prevoutStake;
-                pindexNew->vchBlockSig    = diskindex.vchBlockSig; // qtum
-
-                // RingCT
-                pindexNew->nAnonOutputs   = diskindex.nAnonOutputs;
-
-                if (!CheckIndexProof(*pindexNew, Params().GetConsensus()))
-                    return error("%s: CheckIndexProof failed: %s", __func__, pindexNew->ToString());
-
-                // NovaCoin: build setStakeSeen
-                if (pindexNew->IsProofOfStake())
-                    setStakeSeen.insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
-
-                pcursor->Next();
-            } else {
-                return error("%s: failed to read value", __func__);
-            }
-        } else {
+        if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX || *key.second.begin() >= nEnd)
             break;
+
+        CDiskBlockIndex diskindex;
+        if (!pcursor->GetValue(diskindex))
+            return error("%s: failed to read value", __func__);
+
+        // Construct block index object
+        LoadedBlockIndex entry;
+        entry.hash = diskindex.GetBlockHash();
+        entry.hashPrev = diskindex.hashPrev;
+        entry.pindex = new CBlockIndex();
+        CBlockIndex* pindexNew = entry.pindex;
+        pindexNew->nHeight        = diskindex.nHeight;
+        pindexNew->nFile          = diskindex.nFile;
+        pindexNew->nDataPos       = diskindex.nDataPos;
+        pindexNew->nUndoPos       = diskindex.nUndoPos;
+        pindexNew->nVersion       = diskindex.nVersion;
+        pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+        pindexNew->nTime          = diskindex.nTime;
+        pindexNew->nBits          = diskindex.nBits;
+        pindexNew->nNonce         = diskindex.nNonce;
+        pindexNew->nMoneySupply   = diskindex.nMoneySupply;
+        pindexNew->nStatus        = diskindex.nStatus;
+        pindexNew->nTx            = diskindex.nTx;
+
+        pindexNew->hashStateRoot  = diskindex.hashStateRoot; // qtum
+        pindexNew->hashUTXORoot   = diskindex.hashUTXORoot; // qtum
+        pindexNew->nStakeModifier = diskindex.nStakeModifier;
+        pindexNew->prevoutStake   = diskindex.prevoutStake;
+        // vchBlockSig is not kept in memory, see CBlockSigStore
+
+        // RingCT
+        pindexNew->nAnonOutputs   = diskindex.nAnonOutputs;
+
+        pindexNew->phashBlock = &entry.hash;
+        bool fProofOk = CheckIndexProof(*pindexNew, consensusParams);
+        pindexNew->phashBlock = nullptr;
+        vLoaded.push_back(entry);
+        if (!fProofOk)
+            return error("%s: CheckIndexProof failed: %s", __func__, entry.hash.ToString());
+
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&, CBlockIndex*)> insertBlockIndex, std::vector<CBlockIndex*>& vSortedByHeight)
+{
+    // Block hashes are uniformly distributed, so splitting the key space on
+    // the first hash byte gives every loader thread a similar share.
+    int nThreads = std::max(1, std::min(GetNumCores(), MAX_BLOCK_INDEX_LOAD_THREADS));
+    std::vector<std::vector<LoadedBlockIndex> > vLoaded(nThreads);
+    std::vector<char> vFailed(nThreads, 0);
+    std::vector<std::thread> vThreads;
+    for (int t = 0; t < nThreads; t++) {
+        int nBegin = t * 256 / nThreads;
+        int nEnd = (t + 1) * 256 / nThreads;
+        vThreads.emplace_back([&, t, nBegin, nEnd]() {
+            vFailed[t] = !LoadBlockIndexRange(*this, consensusParams, nBegin, nEnd, vLoaded[t]);
+        });
+    }
+    for (auto& thread : vThreads) {
+        thread.join();
+    }
+
+    std::vector<LoadedBlockIndex> vAll;
+    size_t nTotal = 0;
+    for (const auto& v : vLoaded) {
+        nTotal += v.size();
+    }
+    vAll.reserve(nTotal);
+    for (auto& v : vLoaded) {
+        vAll.insert(vAll.end(), v.begin(), v.end());
+        std::vector<LoadedBlockIndex>().swap(v);
+    }
+
+    if (std::count(vFailed.begin(), vFailed.end(), 1) > 0) {
+        for (const auto& entry : vAll) {
+            delete entry.pindex;
         }
+        boost::this_thread::interruption_point();
+        return false;
+    }
+
+    // Link in height order: a parent is always in the map before its children.
+    std::sort(vAll.begin(), vAll.end(), [](const LoadedBlockIndex& a, const LoadedBlockIndex& b) {
+        return a.pindex->nHeight < b.pindex->nHeight || (a.pindex->nHeight == b.pindex->nHeight && a.hash < b.hash);
+    });
+
+    vSortedByHeight.clear();
+    vSortedByHeight.reserve(vAll.size());
+    for (const auto& entry : vAll) {
+        CBlockIndex* pindexNew = insertBlockIndex(entry.hash, entry.pindex);
+        pindexNew->pprev = insertBlockIndex(entry.hashPrev, nullptr);
+        vSortedByHeight.push_back(pindexNew);
+
+        // NovaCoin: build setStakeSeen
+        if (pindexNew->IsProofOfStake())
+            setStakeSeen.insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
     }
 
     return true;
 }
 
+bool CBlockTreeDB::ReadBlockSig(const uint256 &hash, std::vector<unsigned char> &vchBlockSig)
+{
+    CDiskBlockIndex diskindex;
+    if (!Read(std::make_pair(DB_BLOCK_INDEX, hash), diskindex))
+        return false;
+    vchBlockSig = std::move(diskindex.vchBlockSig);
+    return true;
+}
+
 bool CBlockTreeDB::ReadRCTOutput(int64_t i, CAnonOutput &ao)
 {
     return Read(std::make_pair(DB_RCTOUTPUT, i), ao);
 };
 
+bool CBlockTreeDB::ReadRCTOutputs(const std::set<int64_t> &setIndices, std::map<int64_t, CAnonOutput> &mapOutputs)
+{
+    // One iterator gives all reads the same snapshot. It is still one seek per
+    // index: keys hold the index little endian, so consecutive indices are not
+    // adjacent in the db and cannot be read with a range scan.
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    std::pair<char, int64_t> key;
+    for (const auto i : setIndices) {
+        pcursor->Seek(std::make_pair(DB_RCTOUTPUT, i));
+        if (!pcursor->Valid()
+            || !pcursor->GetKey(key) || key.first != DB_RCTOUTPUT || key.second != i) {
+            return false;
+        }
+
+        CAnonOutput ao;
+        if (!pcursor->GetValue(ao)) {
+            return false;
+        }
+        mapOutputs[i] = ao;
+    }
+
+    return true;
+};
+
 bool CBlockTreeDB::WriteRCTOutput(int64_t i, const CAnonOutput &ao)
 {
     CDBBatch batch(*this);
@@ -507,6 +619,64 @@ bool CBlockTreeDB::EraseRCTOutput(int64_t i)
     return WriteBatch(batch);
 };
 
+bool CBlockTreeDB::UpgradeRCTOutputPoints(int64_t nLastIndex)
+{
+    bool fUpgraded;
+    if (ReadFlag("rctoutputpoints", fUpgraded) && fUpgraded) {
+        return true;
+    }
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_RCTOUTPUT, int64_t(0)));
+
+    int64_t count = 0;
+    LogPrintf("Precomputing anon output points...\n");
+    LogPrintf("[0%%]..."); /* Continued */
+    uiInterface.ShowProgress(_("Upgrading block index database"), 0, true);
+    size_t batch_size = 1 << 24;
+    CDBBatch batch(*this);
+    int reportDone = 0;
+    std::pair<char, int64_t> key;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (ShutdownRequested()) {
+            break;
+        }
+        if (!pcursor->GetKey(key) || key.first != DB_RCTOUTPUT) {
+            break;
+        }
+        if (count++ % 1024 == 0 && nLastIndex > 0) {
+            int percentageDone = (int)std::min<int64_t>(100, count * 100 / nLastIndex);
+            uiInterface.ShowProgress(_("Upgrading block index database"), percentageDone, true);
+            if (reportDone < percentageDone/10) {
+                // report max. every 10% step
+                LogPrintf("[%d%%]...", percentageDone); /* Continued */
+                reportDone = percentageDone/10;
+            }
+        }
+        CAnonOutput ao;
+        if (!pcursor->GetValue(ao)) {
+            return error("%s: cannot parse CAnonOutput record", __func__);
+        }
+        // Outputs with an invalid pubkey are never valid ring members and keep no points
+        if (!ao.HavePoints() && ao.SetPoints()) {
+            batch.Write(std::make_pair(DB_RCTOUTPUT, key.second), ao);
+        }
+        if (batch.SizeEstimate() > batch_size) {
+            WriteBatch(batch);
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+    if (!ShutdownRequested()) {
+        batch.Write(std::make_pair(DB_FLAG, std::string("rctoutputpoints")), '1');
+    }
+    WriteBatch(batch);
+    uiInterface.ShowProgress("", 100, false);
+    LogPrintf("[%s].\n", ShutdownRequested() ? "CANCELLED" : "DONE");
+    return !ShutdownRequested();
+};
+
 
 bool CBlockTreeDB::ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i)
 {
@@ -546,6 +716,29 @@ bool CBlockTreeDB::EraseRCTKeyImage(const CCmpPubKey &ki)
     return WriteBatch(batch);
 };
 
+bool CBlockTreeDB::ForEachRCTKeyImage(const std::function<void(const CCmpPubKey &ki)> &fn)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_RCTKEYIMAGE, CCmpPubKey()));
+
+    char prefix;
+    std::pair<char, CCmpPubKey> key;
+    while (pcursor->Valid()) {
+        if (ShutdownRequested()) {
+            return false;
+        }
+        if (!pcursor->GetKey(prefix) || prefix != DB_RCTKEYIMAGE) {
+            break;
+        }
+        if (!pcursor->GetKey(key)) {
+            return error("%s: failed to read key image", __func__);
+        }
+        fn(key.second);
+        pcursor->Next();
+    }
+    return true;
+};
+
 namespace {
 
 //! Legacy class to deserialize pre-pertxout database entries without reindex.
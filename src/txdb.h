@@ -14,6 +14,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,6 +49,8 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Max threads used to decode the block index at startup
+static const int MAX_BLOCK_INDEX_LOAD_THREADS = 16;
 
 struct CDiskTxPos : public CDiskBlockPos
 {
@@ -129,11 +132,22 @@ public:
     void ReadReindexing(bool &fReindexing);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    /**
+     * Decode the block index on up to MAX_BLOCK_INDEX_LOAD_THREADS threads, then link it in height order.
+     * insertBlockIndex takes ownership of a decoded entry, or creates an empty one when passed nullptr.
+     * vSortedByHeight receives the loaded entries ordered by height.
+     */
+    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&, CBlockIndex*)> insertBlockIndex, std::vector<CBlockIndex*>& vSortedByHeight);
+    //! Read the proof-of-stake signature of a stored block index entry.
+    bool ReadBlockSig(const uint256 &hash, std::vector<unsigned char> &vchBlockSig);
 
     bool ReadRCTOutput(int64_t i, CAnonOutput &ao);
+    /** Read a set of anon outputs from one snapshot, one seek each, fails if any index is missing */
+    bool ReadRCTOutputs(const std::set<int64_t> &setIndices, std::map<int64_t, CAnonOutput> &mapOutputs);
     bool WriteRCTOutput(int64_t i, const CAnonOutput &ao);
     bool EraseRCTOutput(int64_t i);
+    /** Rewrite the anon outputs indexed before the points were kept with their points, nLastIndex is only used for progress */
+    bool UpgradeRCTOutputPoints(int64_t nLastIndex);
 
     bool ReadRCTOutputLink(const CCmpPubKey &pk, int64_t &i);
     bool WriteRCTOutputLink(const CCmpPubKey &pk, int64_t i);
@@ -142,6 +156,8 @@ public:
     bool ReadRCTKeyImage(const CCmpPubKey &ki, uint256 &txhash);
     bool WriteRCTKeyImage(const CCmpPubKey &ki, const uint256 &txhash);
     bool EraseRCTKeyImage(const CCmpPubKey &ki);
+    /** Call fn for every stored key image, fails on a bad record or shutdown */
+    bool ForEachRCTKeyImage(const std::function<void(const CCmpPubKey &ki)> &fn);
 
     ////////////////////////////////////////////////////////////////////////////// // qtum
     bool WriteHeightIndex(const CHeightTxIndexKey &heightIndex, const std::vector<uint256>& hash);
@@ -930,8 +930,7 @@ bool CTxMemPool::HaveKeyImage(const CCmpPubKey &ki, uint256 &hash) const
 {
     LOCK(cs);
 
-    std::map<CCmpPubKey, uint256>::const_iterator mi;
-    mi = mapKeyImages.find(ki);
+    auto mi = mapKeyImages.find(ki);
 
     if (mi != mapKeyImages.end()) {
         hash = mi->second;
@@ -973,7 +972,7 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
                 coin = Coin(txout, MEMPOOL_HEIGHT, false);
                 if (out->IsType(OUTPUT_CT)) {
                     coin.nType = OUTPUT_CT;
-                    coin.commitment = ((CTxOutCT*)out)->commitment;
+                    coin.commitment.Set() = ((CTxOutCT*)out)->commitment;
                 }
                 return true;
             }
@@ -1179,3 +1178,5 @@ void CTxMemPool::GetTransactionAncestry(const uint256& txid, size_t& ancestors,
 }
 
 SaltedTxidHasher::SaltedTxidHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+SaltedKeyImageHasher::SaltedKeyImageHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
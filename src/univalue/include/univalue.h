@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
@@ -48,7 +49,6 @@ public:
         std::string s(val_);
         setStr(s);
     }
-    ~UniValue() {}
 
     void clear();
 
@@ -113,6 +113,9 @@ public:
     bool push_backV(const std::vector<UniValue>& vec);
 
     void __pushKV(const std::string& key, const UniValue& val);
+    // Append without the duplicate key scan of pushKV; the caller must know
+    // the key is not present yet.
+    bool pushKVEnd(const std::string& key, UniValue val);
     bool pushKV(const std::string& key, const UniValue& val);
     bool pushKV(const std::string& key, const std::string& val_) {
         UniValue tmpVal(VSTR, val_);
@@ -147,6 +150,12 @@ public:
     std::string write(unsigned int prettyIndent = 0,
                       unsigned int indentLevel = 0) const;
 
+    // Serialize in pieces of roughly flushSize bytes, handing each one to
+    // sink as it fills up, so large documents never exist as one string.
+    typedef std::function<void(const std::string&)> WriteSink;
+    void write(const WriteSink& sink, unsigned int prettyIndent = 0,
+               size_t flushSize = 65536) const;
+
     bool read(const char *raw, size_t len);
     bool read(const char *raw) { return read(raw, strlen(raw)); }
     bool read(const std::string& rawStr) {
@@ -160,8 +169,12 @@ private:
     std::vector<UniValue> values;
 
     bool findKey(const std::string& key, size_t& retIdx) const;
-    void writeArray(unsigned int prettyIndent, unsigned int indentLevel, std::string& s) const;
-    void writeObject(unsigned int prettyIndent, unsigned int indentLevel, std::string& s) const;
+    void writeTo(unsigned int prettyIndent, unsigned int indentLevel, std::string& s,
+                 const WriteSink* sink, size_t flushSize) const;
+    void writeArray(unsigned int prettyIndent, unsigned int indentLevel, std::string& s,
+                    const WriteSink* sink, size_t flushSize) const;
+    void writeObject(unsigned int prettyIndent, unsigned int indentLevel, std::string& s,
+                     const WriteSink* sink, size_t flushSize) const;
 
 public:
     // Strict type-specific getters, these throw std::runtime_error if the
@@ -10,11 +10,8 @@
 
 using namespace std;
 
-static string json_escape(const string& inS)
+static void json_escape(const string& inS, string& outS)
 {
-    string outS;
-    outS.reserve(inS.size() * 2);
-
     for (unsigned int i = 0; i < inS.size(); i++) {
         unsigned char ch = inS[i];
         const char *escStr = escapes[ch];
@@ -24,8 +21,6 @@ static string json_escape(const string& inS)
         else
             outS += ch;
     }
-
-    return outS;
 }
 
 string UniValue::write(unsigned int prettyIndent,
@@ -34,6 +29,29 @@ string UniValue::write(unsigned int prettyIndent,
     string s;
     s.reserve(1024);
 
+    writeTo(prettyIndent, indentLevel, s, nullptr, 0);
+
+    return s;
+}
+
+void UniValue::write(const WriteSink& sink, unsigned int prettyIndent,
+                     size_t flushSize) const
+{
+    string s;
+    s.reserve(flushSize + 1024);
+
+    writeTo(prettyIndent, 0, s, &sink, flushSize);
+
+    if (!s.empty())
+        sink(s);
+}
+
+// Nested values append to the caller's buffer instead of returning their
+// own string, so every byte is copied once; with a sink the buffer is
+// drained between array and object members.
+void UniValue::writeTo(unsigned int prettyIndent, unsigned int indentLevel, string& s,
+                       const WriteSink* sink, size_t flushSize) const
+{
     unsigned int modIndent = indentLevel;
     if (modIndent == 0)
         modIndent = 1;
@@ -43,13 +61,15 @@ string UniValue::write(unsigned int prettyIndent,
         s += "null";
         break;
     case VOBJ:
-        writeObject(prettyIndent, modIndent, s);
+        writeObject(prettyIndent, modIndent, s, sink, flushSize);
         break;
     case VARR:
-        writeArray(prettyIndent, modIndent, s);
+        writeArray(prettyIndent, modIndent, s, sink, flushSize);
         break;
     case VSTR:
-        s += "\"" + json_escape(val) + "\"";
+        s += "\"";
+        json_escape(val, s);
+        s += "\"";
         break;
     case VNUM:
         s += val;
@@ -58,8 +78,6 @@ string UniValue::write(unsigned int prettyIndent,
         s += (val == "1" ? "true" : "false");
         break;
     }
-
-    return s;
 }
 
 static void indentStr(unsigned int prettyIndent, unsigned int indentLevel, string& s)
@@ -67,7 +85,16 @@ static void indentStr(unsigned int prettyIndent, unsigned int indentLevel, strin
     s.append(prettyIndent * indentLevel, ' ');
 }
 
-void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, string& s) const
+static void flushTo(const UniValue::WriteSink* sink, size_t flushSize, string& s)
+{
+    if (sink && s.size() >= flushSize) {
+        (*sink)(s);
+        s.clear();
+    }
+}
+
+void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, string& s,
+                          const WriteSink* sink, size_t flushSize) const
 {
     s += "[";
     if (prettyIndent)
@@ -76,12 +103,13 @@ void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, s
     for (unsigned int i = 0; i < values.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += values[i].write(prettyIndent, indentLevel + 1);
+        values[i].writeTo(prettyIndent, indentLevel + 1, s, sink, flushSize);
         if (i != (values.size() - 1)) {
             s += ",";
         }
         if (prettyIndent)
             s += "\n";
+        flushTo(sink, flushSize, s);
     }
 
     if (prettyIndent)
@@ -89,7 +117,8 @@ void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, s
     s += "]";
 }
 
-void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel, string& s) const
+void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel, string& s,
+                           const WriteSink* sink, size_t flushSize) const
 {
     s += "{";
     if (prettyIndent)
@@ -98,18 +127,20 @@ void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel,
     for (unsigned int i = 0; i < keys.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += "\"" + json_escape(keys[i]) + "\":";
+        s += "\"";
+        json_escape(keys[i], s);
+        s += "\":";
         if (prettyIndent)
             s += " ";
-        s += values.at(i).write(prettyIndent, indentLevel + 1);
+        values.at(i).writeTo(prettyIndent, indentLevel + 1, s, sink, flushSize);
         if (i != (values.size() - 1))
             s += ",";
         if (prettyIndent)
             s += "\n";
+        flushTo(sink, flushSize, s);
     }
 
     if (prettyIndent)
         indentStr(prettyIndent, indentLevel - 1, s);
     s += "}";
 }
-
@@ -393,6 +393,57 @@ BOOST_AUTO_TEST_CASE(univalue_readwrite)
     BOOST_CHECK(!v.read("{} 42"));
 }
 
+BOOST_AUTO_TEST_CASE(univalue_pushkvend)
+{
+    UniValue obj(UniValue::VOBJ);
+    BOOST_CHECK(obj.pushKVEnd("a", 1));
+    BOOST_CHECK(obj.pushKVEnd("b", "two"));
+    BOOST_CHECK_EQUAL(obj.size(), 2);
+    BOOST_CHECK_EQUAL(obj["b"].getValStr(), "two");
+    BOOST_CHECK_EQUAL(obj.write(), "{\"a\":1,\"b\":\"two\"}");
+
+    UniValue arr(UniValue::VARR);
+    BOOST_CHECK(!arr.pushKVEnd("a", 1));
+    BOOST_CHECK(arr.empty());
+}
+
+BOOST_AUTO_TEST_CASE(univalue_streamwrite)
+{
+    UniValue obj(UniValue::VOBJ);
+    UniValue arr(UniValue::VARR);
+    for (int i = 0; i < 1000; i++) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("n", i);
+        entry.pushKV("s", "line\n\"quoted\"");
+        arr.push_back(entry);
+    }
+    obj.pushKV("entries", arr);
+    obj.pushKV("empty", UniValue(UniValue::VARR));
+    obj.pushKV("null", NullUniValue);
+
+    for (unsigned int indent = 0; indent < 3; indent++) {
+        std::string streamed;
+        size_t chunks = 0;
+        obj.write([&](const std::string& chunk) {
+            BOOST_CHECK(!chunk.empty());
+            streamed += chunk;
+            chunks++;
+        }, indent, 256);
+        BOOST_CHECK_EQUAL(streamed, obj.write(indent));
+        BOOST_CHECK(chunks > 1);
+    }
+
+    // A scalar, or a document smaller than the flush size, is one chunk
+    std::string streamed;
+    size_t chunks = 0;
+    UniValue("x").write([&](const std::string& chunk) {
+        streamed += chunk;
+        chunks++;
+    });
+    BOOST_CHECK_EQUAL(streamed, "\"x\"");
+    BOOST_CHECK_EQUAL(chunks, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 int main (int argc, char *argv[])
@@ -403,6 +454,8 @@ int main (int argc, char *argv[])
     univalue_array();
     univalue_object();
     univalue_readwrite();
+    univalue_pushkvend();
+    univalue_streamwrite();
     return 0;
 }
 
@@ -18,6 +18,8 @@
 #include <cuckoocache.h>
 #include <hash.h>
 #include <index/txindex.h>
+#include <memusage.h>
+#include <msgstats.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
@@ -49,6 +51,7 @@
 #include <wallet/wallet.h>
 
 #include <future>
+#include <iterator>
 #include <sstream>
 
 #include <boost/algorithm/string/replace.hpp>
@@ -192,7 +195,8 @@ public:
     // Block (dis)connection on a given view:
     DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool* pfClean);
     bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false);
+                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false,
+                    std::vector<TransactionReceiptInfo>* pvReceipts = nullptr);
     bool UpdateHashProof(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view);
 
     // Block disconnection on our pcoinsTip:
@@ -217,7 +221,7 @@ private:
 
     CBlockIndex* AddToBlockIndex(const CBlockHeader& block) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     /** Create a new block index entry for a given block hash */
-    CBlockIndex* InsertBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    CBlockIndex* InsertBlockIndex(const uint256& hash, CBlockIndex* pindexLoaded = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     /**
      * Make various assertions about the state of the block index.
      *
@@ -256,6 +260,7 @@ bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 size_t nCoinCacheUsage = 5000 * 300;
+int64_t nBlockIndexLoadTime = 0;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
 bool fEnableReplacement = DEFAULT_ENABLE_REPLACEMENT;
@@ -1178,6 +1183,7 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
                         bool* pfMissingInputs, std::list<CTransactionRef>* plTxnReplaced,
                         bool bypass_limits, const CAmount nAbsurdFee, bool test_accept, bool rawTx)
 {
+    StageTimer timer(ValidationStage::ACCEPT_TO_MEMORY_POOL);
     const CChainParams& chainparams = Params();
     return AcceptToMemoryPoolWithTime(chainparams, pool, state, tx, pfMissingInputs, GetTime(), plTxnReplaced, bypass_limits, nAbsurdFee, test_accept, rawTx);
 }
@@ -1339,7 +1345,7 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
-bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& message_start)
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& message_start, const uint256* phash)
 {
     CDiskBlockPos hpos = pos;
     hpos.nPos -= 8; // Seek back 8 bytes for meta header
@@ -1365,6 +1371,19 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos,
                     blk_size, MAX_SIZE);
         }
 
+        if (phash) {
+            // Only the header is decoded, the block itself is returned as stored
+            CBlockHeader header;
+            filein >> header;
+            if (header.GetHash() != *phash) {
+                return error("%s: Block hash mismatch for %s: %s versus expected %s", __func__, pos.ToString(),
+                        header.GetHash().ToString(), phash->ToString());
+            }
+            if (fseek(filein.Get(), pos.nPos, SEEK_SET)) {
+                return error("%s: Seek in block file failed for %s", __func__, pos.ToString());
+            }
+        }
+
         block.resize(blk_size); // Zeroing of memory is intentional here
         filein.read((char*)block.data(), blk_size);
     } catch(const std::exception& e) {
@@ -1382,7 +1401,8 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex
         block_pos = pindex->GetBlockPos();
     }
 
-    return ReadRawBlockFromDisk(block, block_pos, message_start);
+    const uint256 hash = pindex->GetBlockHash();
+    return ReadRawBlockFromDisk(block, block_pos, message_start, &hash);
 }
 
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
@@ -1670,7 +1690,7 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
                     memcpy(vchAmount.data(), &coin.out.nValue, sizeof(coin.out.nValue));
                 } else if (coin.nType == OUTPUT_CT) {
                     vchAmount.resize(33);
-                    memcpy(vchAmount.data(), coin.commitment.data, 33);
+                    memcpy(vchAmount.data(), coin.commitment.Get().data, 33);
                 }
 
                 // Verify signature
@@ -2025,6 +2045,128 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+namespace {
+/**
+ * Closure representing one check of PreValidateTransaction, run outside
+ * cs_main: a range proof, the MLSAGs of the anon inputs, or a script
+ */
+class CTxPreCheck
+{
+public:
+    enum Kind { NONE, OUTPUT, MLSAG, SCRIPT };
+
+private:
+    Kind kind;
+    const CTransaction *ptx;
+    unsigned int n;
+    CScriptCheck script;
+
+public:
+    CTxPreCheck() : kind(NONE), ptx(nullptr), n(0) {}
+    CTxPreCheck(Kind kindIn, const CTransaction &txIn, unsigned int nIn) : kind(kindIn), ptx(&txIn), n(nIn) {}
+    explicit CTxPreCheck(CScriptCheck &scriptIn) : kind(SCRIPT), ptx(nullptr), n(0) { script.swap(scriptIn); }
+
+    bool operator()()
+    {
+        CValidationState state;
+        switch (kind) {
+        case OUTPUT: {
+            const CTxOutBase *out = ptx->vpout[n].get();
+            if (out->IsType(OUTPUT_CT))
+                return CheckBlindOutput(state, (const CTxOutCT*) out);
+            return CheckAnonOutput(state, (const CTxOutRingCT*) out);
+        }
+        case MLSAG:
+            return VerifyMLSAG(*ptx, state, false);
+        case SCRIPT:
+            return script();
+        case NONE:
+            break;
+        }
+        return true;
+    }
+
+    void swap(CTxPreCheck &check)
+    {
+        std::swap(kind, check.kind);
+        std::swap(ptx, check.ptx);
+        std::swap(n, check.n);
+        script.swap(check.script);
+    }
+};
+} // namespace
+
+static CCheckQueue<CTxPreCheck> txprecheckqueue(128);
+
+void ThreadTxPreCheck() {
+    RenameThread("bitcoin-txprech");
+    txprecheckqueue.Thread();
+}
+
+bool PreValidateTransaction(const CTransaction& tx, CValidationState& state)
+{
+    StageTimer timer(ValidationStage::PRE_VALIDATE_TRANSACTION);
+    if (tx.IsCoinBase() || tx.IsCoinStake() || tx.HasOpSpend())
+        return true;
+
+    // A malformed transaction is rejected before any proof is verified
+    if (!CheckTransaction(tx, state, true, false))
+        return false;
+
+    std::vector<CTxPreCheck> vChecks;
+    if (!fSkipRangeproof) {
+        for (unsigned int i = 0; i < tx.vpout.size(); i++) {
+            if (tx.vpout[i]->IsType(OUTPUT_CT) || tx.vpout[i]->IsType(OUTPUT_RINGCT))
+                vChecks.emplace_back(CTxPreCheck::OUTPUT, tx, i);
+        }
+    }
+
+    // Only coins already in memory are used, looking up the rest would pull
+    // them into pcoinsTip for a transaction that may never be accepted.
+    std::vector<std::pair<unsigned int, Coin>> vCoins;
+    bool fHasAnonInput = false;
+    {
+        LOCK(cs_main);
+        CCoinsView viewDummy;
+        CCoinsViewMemPool viewMemPool(&viewDummy, mempool);
+        for (unsigned int i = 0; i < tx.vin.size(); i++) {
+            if (tx.vin[i].IsAnonInput()) {
+                fHasAnonInput = true;
+                continue;
+            }
+            Coin coin;
+            if (viewMemPool.GetCoin(tx.vin[i].prevout, coin)) {
+                vCoins.emplace_back(i, std::move(coin));
+            } else if (pcoinsTip->HaveCoinInCache(tx.vin[i].prevout)) {
+                vCoins.emplace_back(i, pcoinsTip->AccessCoin(tx.vin[i].prevout));
+            }
+        }
+    }
+    if (fHasAnonInput)
+        vChecks.emplace_back(CTxPreCheck::MLSAG, tx, 0);
+
+    PrecomputedTransactionData txdata(tx);
+    for (const auto &coin : vCoins) {
+        CScriptCheck check(coin.second.out, tx, coin.first, STANDARD_SCRIPT_VERIFY_FLAGS, true, &txdata);
+        vChecks.emplace_back(check);
+    }
+
+    // Results only warm the proof and signature caches, failures are left to
+    // AcceptToMemoryPool to report.
+    if (nScriptCheckThreads) {
+        CCheckQueueControl<CTxPreCheck> control(&txprecheckqueue);
+        control.Add(vChecks);
+        control.Wait();
+    } else {
+        for (auto &check : vChecks) {
+            if (!check())
+                break;
+        }
+    }
+
+    return CheckTransaction(tx, state);
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2568,7 +2710,8 @@ QtumTransaction QtumTxConverter::createEthTX(const EthTransactionParams& etp, ui
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
 bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck)
+                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck,
+                  std::vector<TransactionReceiptInfo>* pvReceipts)
 {
 
     std::cout << "in connect block\n";
@@ -2968,19 +3111,24 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
             countCumulativeGasUsed += bcer.usedGas;
             std::vector<TransactionReceiptInfo> tri;
-            if (fLogEvents && !fJustCheck)
+            if ((fLogEvents || pvReceipts) && !fJustCheck)
             {
                 for(size_t k = 0; k < resultConvertQtumTX.first.size(); k ++){
-                    dev::Address key = resultExec[k].execRes.newAddress;
-                    if(!heightIndexes.count(key)){
-                        heightIndexes[key].first = CHeightTxIndexKey(pindex->nHeight, resultExec[k].execRes.newAddress);
+                    if (fLogEvents) {
+                        dev::Address key = resultExec[k].execRes.newAddress;
+                        if(!heightIndexes.count(key)){
+                            heightIndexes[key].first = CHeightTxIndexKey(pindex->nHeight, resultExec[k].execRes.newAddress);
+                        }
+                        heightIndexes[key].second.push_back(tx.GetHash());
                     }
-                    heightIndexes[key].second.push_back(tx.GetHash());
                     tri.push_back(TransactionReceiptInfo{block.GetHash(), uint32_t(pindex->nHeight), tx.GetHash(), uint32_t(i), resultConvertQtumTX.first[k].from(), resultConvertQtumTX.first[k].to(),
                                 countCumulativeGasUsed, uint64_t(resultExec[k].execRes.gasUsed), resultExec[k].execRes.newAddress, resultExec[k].txRec.log(), resultExec[k].execRes.excepted});
                 }
 
-                pstorageresult->addResult(uintToh256(tx.GetHash()), tri);
+                if (fLogEvents)
+                    pstorageresult->addResult(uintToh256(tx.GetHash()), tri);
+                if (pvReceipts)
+                    std::move(tri.begin(), tri.end(), std::back_inserter(*pvReceipts));
             }
 
             blockGasUsed += bcer.usedGas;
@@ -3067,6 +3215,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
                 op.n = k;
                 view.nLastRCTOutput++;
                 CAnonOutput ao(txout->pk, txout->commitment, op, pindex->nHeight, 0);
+                // Decompress pk and hash it to the curve once, instead of in every ring it joins
+                ao.SetPoints();
 
                 view.anonOutputLinks[txout->pk] = view.nLastRCTOutput;
                 view.anonOutputs.emplace_back(std::make_pair(view.nLastRCTOutput, ao));
@@ -3301,6 +3451,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                 if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
                     return AbortNode(state, "Failed to write to block index database");
                 }
+                for (const CBlockIndex* pindex : vBlocks) {
+                    g_block_sigs.Release(pindex);
+                }
             }
             // Finally remove any pruned files
             if (fFlushForPrune)
@@ -3393,6 +3546,8 @@ bool FlushView(CCoinsViewCache *view, CValidationState& state, bool fDisconnecti
 
         if (!pblocktree->WriteBatch(batch))
             return error("%s: Write RCT outputs failed.", __func__);
+
+        AddKeyImagesToFilter(view->keyImages);
     }
 
     view->nLastRCTOutput = 0;
@@ -3537,6 +3692,7 @@ struct PerBlockConnectTrace {
     CBlockIndex* pindex = nullptr;
     std::shared_ptr<const CBlock> pblock;
     std::shared_ptr<std::vector<CTransactionRef>> conflictedTxs;
+    std::shared_ptr<const std::vector<TransactionReceiptInfo>> receipts;
     PerBlockConnectTrace() : conflictedTxs(std::make_shared<std::vector<CTransactionRef>>()) {}
 };
 /**
@@ -3569,12 +3725,13 @@ public:
         pool.NotifyEntryRemoved.disconnect(boost::bind(&ConnectTrace::NotifyEntryRemoved, this, _1, _2));
     }
 
-    void BlockConnected(CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock) {
+    void BlockConnected(CBlockIndex* pindex, std::shared_ptr<const CBlock> pblock, std::shared_ptr<const std::vector<TransactionReceiptInfo>> receipts) {
         assert(!blocksConnected.back().pindex);
         assert(pindex);
         assert(pblock);
         blocksConnected.back().pindex = pindex;
         blocksConnected.back().pblock = std::move(pblock);
+        blocksConnected.back().receipts = std::move(receipts);
         blocksConnected.emplace_back();
     }
 
@@ -3620,6 +3777,8 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     }
 
     const CBlock& blockConnecting = *pthisBlock;
+    // Contract receipts, handed to listeners along with BlockConnected
+    std::shared_ptr<std::vector<TransactionReceiptInfo>> receipts = std::make_shared<std::vector<TransactionReceiptInfo>>();
 
     // Apply the block atomically to the chain state.
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
@@ -3632,7 +3791,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
         dev::h256 oldHashStateRoot(globalState->rootHash()); // qtum
         dev::h256 oldHashUTXORoot(globalState->rootHashUTXO()); // qtum
 
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams, false, receipts.get());
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -3671,7 +3830,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     LogPrint(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime5) * MILLI, nTimePostConnect * MICRO, nTimePostConnect * MILLI / nBlocksTotal);
     LogPrint(BCLog::BENCH, "- Connect block: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime6 - nTime1) * MILLI, nTimeTotal * MICRO, nTimeTotal * MILLI / nBlocksTotal);
 
-    connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
+    connectTrace.BlockConnected(pindexNew, std::move(pthisBlock), std::move(receipts));
     return true;
 }
 
@@ -3924,6 +4083,8 @@ bool CChainState::ActivateBestChain(CValidationState &state, const CChainParams&
                 for (const PerBlockConnectTrace& trace : connectTrace.GetBlocksConnected()) {
                     assert(trace.pblock && trace.pindex);
                     GetMainSignals().BlockConnected(trace.pblock, trace.pindex, trace.conflictedTxs);
+                    if (!trace.receipts->empty())
+                        GetMainSignals().BlockReceiptsConnected(trace.pblock, trace.pindex, trace.receipts);
                 }
             } while (!chainActive.Tip() || (starting_tip && CBlockIndexWorkComparator()(chainActive.Tip(), starting_tip)));
             if (!blocks_connected) return true;
@@ -4120,6 +4281,8 @@ CBlockIndex* CChainState::AddToBlockIndex(const CBlockHeader& block)
     // to avoid miners withholding blocks but broadcasting headers, to get a
     // competitive advantage.
     pindexNew->nSequenceId = 0;
+    // Held in memory until the entry is written to the block tree db
+    g_block_sigs.Add(pindexNew, block.vchBlockSig);
     BlockMap::iterator mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     if (pindexNew->IsProofOfStake())
         setStakeSeen.insert(std::make_pair(pindexNew->prevoutStake, pindexNew->nTime));
@@ -5003,6 +5166,7 @@ bool CheckCanonicalBlockSignature(const std::shared_ptr<const CBlock> pblock)
 bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<const CBlock> pblock, bool fForceProcessing, bool *fNewBlock)
 {
     AssertLockNotHeld(cs_main);
+    StageTimer timer(ValidationStage::PROCESS_NEW_BLOCK);
 
     {
         CBlockIndex *pindex = nullptr;
@@ -5279,20 +5443,28 @@ fs::path GetBlockPosFilename(const CDiskBlockPos &pos, const char *prefix)
     return GetBlocksDir() / strprintf("%s%05u.dat", prefix, pos.nFile);
 }
 
-CBlockIndex * CChainState::InsertBlockIndex(const uint256& hash)
+CBlockIndex * CChainState::InsertBlockIndex(const uint256& hash, CBlockIndex* pindexLoaded)
 {
     AssertLockHeld(cs_main);
 
-    if (hash.IsNull())
+    if (hash.IsNull()) {
+        delete pindexLoaded;
         return nullptr;
+    }
 
-    // Return existing
+    // Return existing, filling in a placeholder from the loaded entry
     BlockMap::iterator mi = mapBlockIndex.find(hash);
-    if (mi != mapBlockIndex.end())
+    if (mi != mapBlockIndex.end()) {
+        if (pindexLoaded) {
+            *(*mi).second = *pindexLoaded;
+            (*mi).second->phashBlock = &((*mi).first);
+            delete pindexLoaded;
+        }
         return (*mi).second;
+    }
 
-    // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
+    // Create new, or take ownership of the loaded entry
+    CBlockIndex* pindexNew = pindexLoaded ? pindexLoaded : new CBlockIndex();
     mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     pindexNew->phashBlock = &((*mi).first);
 
@@ -5301,23 +5473,27 @@ CBlockIndex * CChainState::InsertBlockIndex(const uint256& hash)
 
 bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlockTreeDB& blocktree)
 {
-    if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }))
+    std::vector<CBlockIndex*> vSortedByHeight;
+    if (!blocktree.LoadBlockIndexGuts(consensus_params, [this](const uint256& hash, CBlockIndex* pindexLoaded) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash, pindexLoaded); }, vSortedByHeight))
         return false;
 
     boost::this_thread::interruption_point();
 
-    // Calculate nChainWork
-    std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
-    for (const std::pair<const uint256, CBlockIndex*>& item : mapBlockIndex)
-    {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
+    // Entries whose parent was never stored are placeholders the loader did
+    // not return; only then is a full walk of mapBlockIndex needed.
+    if (vSortedByHeight.size() != mapBlockIndex.size()) {
+        vSortedByHeight.clear();
+        vSortedByHeight.reserve(mapBlockIndex.size());
+        for (const std::pair<const uint256, CBlockIndex*>& item : mapBlockIndex)
+            vSortedByHeight.push_back(item.second);
+        std::stable_sort(vSortedByHeight.begin(), vSortedByHeight.end(), [](const CBlockIndex* a, const CBlockIndex* b) {
+            return a->nHeight < b->nHeight;
+        });
     }
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
+
+    // Calculate nChainWork
+    for (CBlockIndex* pindex : vSortedByHeight)
     {
-        CBlockIndex* pindex = item.second;
         pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
@@ -5806,19 +5982,37 @@ void UnloadBlockIndex()
         delete entry.second;
     }
     mapBlockIndex.clear();
+    g_block_sigs.Clear();
     fHavePruned = false;
 
     g_chainstate.UnloadBlockIndex();
 }
 
+size_t BlockIndexMemoryUsage()
+{
+    AssertLockHeld(cs_main);
+    return memusage::DynamicUsage(mapBlockIndex)
+        + mapBlockIndex.size() * memusage::MallocUsage(sizeof(CBlockIndex))
+        + g_block_sigs.DynamicMemoryUsage();
+}
+
 bool LoadBlockIndex(const CChainParams& chainparams)
 {
+    // Signatures of stored entries are read back on demand
+    g_block_sigs.SetReader([](const CBlockIndex* pindex, std::vector<unsigned char>& vchBlockSig) {
+        return pblocktree && pblocktree->ReadBlockSig(pindex->GetBlockHash(), vchBlockSig);
+    });
+
     // Load block index from databases
     bool needs_init = fReindex;
     if (!fReindex) {
+        int64_t nStart = GetTimeMillis();
         bool ret = LoadBlockIndexDB(chainparams);
         if (!ret) return false;
         needs_init = mapBlockIndex.empty();
+        nBlockIndexLoadTime = GetTimeMillis() - nStart;
+        LogPrintf("%s: loaded %u block index entries in %dms, ~%u kB in memory\n", __func__,
+            mapBlockIndex.size(), nBlockIndexLoadTime, BlockIndexMemoryUsage() / 1024);
     }
 
     if (needs_init) {
@@ -6334,6 +6528,130 @@ bool DumpMempool(void)
     return true;
 }
 
+/**
+ * sigcache.dat holds the network magic, the version, the client version that
+ * wrote it, then for the signature cache and the script execution cache in
+ * turn: the nonce salting the cache entries, the number of entries and the
+ * entries. It ends with the hash of all of the above, which is checked before
+ * anything is loaded. An entry only says that a check passed under the rules
+ * of the client that wrote it, so a file written by another client version is
+ * discarded.
+ */
+static const uint64_t SIGCACHE_DUMP_VERSION = 1;
+
+template <typename Stream>
+static void ReadSigCacheEntries(Stream& s, uint256& nonce, std::vector<uint256>& entries)
+{
+    uint64_t num;
+    s >> nonce >> num;
+    while (num--) {
+        uint256 entry;
+        s >> entry;
+        entries.push_back(entry);
+    }
+}
+
+bool LoadSigCaches()
+{
+    FILE* filestr = fsbridge::fopen(GetDataDir() / "sigcache.dat", "rb");
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open signature cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    uint256 sig_nonce, script_nonce;
+    std::vector<uint256> sig_entries, script_entries;
+    try {
+        CHashVerifier<CAutoFile> verifier(&file);
+        unsigned char pchMsgTmp[4];
+        uint64_t version;
+        int nClientVersion;
+        verifier >> pchMsgTmp >> version >> nClientVersion;
+        if (memcmp(pchMsgTmp, Params().MessageStart(), sizeof(pchMsgTmp)) || version != SIGCACHE_DUMP_VERSION) {
+            return false;
+        }
+        if (nClientVersion != CLIENT_VERSION) {
+            LogPrintf("Signature cache file on disk was written by client version %d, discarding it.\n", nClientVersion);
+            return false;
+        }
+        ReadSigCacheEntries(verifier, sig_nonce, sig_entries);
+        ReadSigCacheEntries(verifier, script_nonce, script_entries);
+        uint256 hashTmp;
+        file >> hashTmp;
+        if (hashTmp != verifier.GetHash()) {
+            LogPrintf("Signature cache file on disk is corrupted. Continuing anyway.\n");
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize signature cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+
+    SetSignatureCacheNonce(sig_nonce);
+    for (const uint256& entry : sig_entries) {
+        AddSignatureCacheEntry(entry);
+    }
+    {
+        LOCK(cs_main);
+        scriptExecutionCacheNonce = script_nonce;
+        for (const uint256& entry : script_entries) {
+            scriptExecutionCache.insert(entry);
+        }
+    }
+
+    LogPrintf("Imported signature cache from disk: %u signature entries, %u script execution entries\n", sig_entries.size(), script_entries.size());
+    return true;
+}
+
+bool DumpSigCaches()
+{
+    int64_t start = GetTimeMicros();
+
+    try {
+        FILE* filestr = fsbridge::fopen(GetDataDir() / "sigcache.dat.new", "wb");
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        CHashWriter hasher(SER_DISK, CLIENT_VERSION);
+
+        uint64_t version = SIGCACHE_DUMP_VERSION;
+        file << Params().MessageStart() << version << CLIENT_VERSION;
+        hasher << Params().MessageStart() << version << CLIENT_VERSION;
+
+        uint64_t num = 0;
+        auto count = [&num](const uint256&) { ++num; };
+        auto write = [&file, &hasher](const uint256& entry) { file << entry; hasher << entry; };
+
+        uint256 nonce = GetSignatureCacheNonce();
+        ForEachSignatureCacheEntry(count);
+        file << nonce << num;
+        hasher << nonce << num;
+        ForEachSignatureCacheEntry(write);
+        {
+            LOCK(cs_main);
+            num = 0;
+            scriptExecutionCache.for_each(count);
+            file << scriptExecutionCacheNonce << num;
+            hasher << scriptExecutionCacheNonce << num;
+            scriptExecutionCache.for_each(write);
+        }
+
+        file << hasher.GetHash();
+        if (!FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        RenameOver(GetDataDir() / "sigcache.dat.new", GetDataDir() / "sigcache.dat");
+        LogPrintf("Dumped signature cache: %gs\n", (GetTimeMicros()-start)*MICRO);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump signature cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
 //! Guess how far we are in the verification process at the given block index
 //! require cs_main if pindex has not been validated yet (because nChainTx might be unset)
 double GuessVerificationProgress(const ChainTxData& data, const CBlockIndex *pindex) {
@@ -151,6 +151,8 @@ static const bool DEFAULT_LOGEVENTS = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
+/** Default for -persistsigcache */
+static const bool DEFAULT_PERSIST_SIGCACHE = false;
 /** Default for -mempoolreplacement */
 static const bool DEFAULT_ENABLE_REPLACEMENT = true;
 /** Default for using fee filter */
@@ -204,6 +206,8 @@ extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
 extern size_t nCoinCacheUsage;
+/** Time in milliseconds it took to load the block index at startup */
+extern int64_t nBlockIndexLoadTime;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
 /** Absolute maximum transaction fee (in satoshis) used by wallet and mempool (rejects high fee in sendrawtransaction) */
@@ -304,8 +308,12 @@ bool LoadBlockIndex(const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs
 bool LoadChainTip(const CChainParams& chainparams);
 /** Unload database information */
 void UnloadBlockIndex();
+/** Estimated heap usage of the block index, including signatures held by CBlockSigStore */
+size_t BlockIndexMemoryUsage() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the transaction pre-validation thread */
+void ThreadTxPreCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -354,6 +362,16 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
                         bool* pfMissingInputs, std::list<CTransactionRef>* plTxnReplaced,
                         bool bypass_limits, const CAmount nAbsurdFee, bool test_accept=false, bool rawTx = false);
 
+/**
+ * Run the expensive context-free checks of a transaction before taking cs_main
+ * for AcceptToMemoryPool: once the cheap structural checks pass, range proofs,
+ * MLSAGs and the scripts of inputs whose coins are in memory are verified on
+ * the pre-validation threads, filling the proof and signature caches. Returns
+ * the CheckTransaction verdict, the other results are left to
+ * AcceptToMemoryPool. Callers should skip transactions they already have.
+ */
+bool PreValidateTransaction(const CTransaction& tx, CValidationState& state);
+
 /** Convert CValidationState to a human-readable message for logging */
 std::string FormatStateMessage(const CValidationState &state);
 
@@ -514,7 +532,9 @@ void InitScriptExecutionCache();
 template <typename Block>
 bool ReadBlockFromDisk(Block& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
-bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& message_start);
+/** Read a block as stored on disk, without deserializing it. When phash is set, the stored header must hash to it. */
+bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& message_start, const uint256* phash = nullptr);
+/** Read a block as stored on disk and check it against the index entry. cs_main is only held to look up its position. */
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
 bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensusParams);
 
@@ -622,6 +642,14 @@ bool DumpMempool();
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Dump the signature and script execution caches to disk. Nothing else may
+ *  use them meanwhile, so this is only done on shutdown. */
+bool DumpSigCaches();
+
+/** Load the signature and script execution caches from disk. Must be called
+ *  after they are set up, before they are used. */
+bool LoadSigCaches();
+
 //! Check whether the block associated with this index entry is pruned or not.
 inline bool IsBlockPruned(const CBlockIndex* pblockindex)
 {
@@ -10,6 +10,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 class CBlock;
 class CBlockIndex;
@@ -23,6 +24,7 @@ class uint256;
 class CScheduler;
 class CTxMemPool;
 enum class MemPoolRemovalReason;
+struct TransactionReceiptInfo;
 
 // These functions dispatch to one or all registered wallets
 
@@ -115,6 +117,14 @@ protected:
      * Called on a background thread.
      */
     virtual void BlockDisconnected(const std::shared_ptr<const CBlock> &block) {}
+    /**
+     * Notifies listeners of the contract receipts generated while connecting
+     * a block, in block order. Delivered right after BlockConnected for the
+     * same block, and only for blocks that executed contracts.
+     *
+     * Called on a background thread.
+     */
+    virtual void BlockReceiptsConnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex *pindex, const std::vector<TransactionReceiptInfo> &receipts) {}
     /**
      * Notifies listeners of the new active block chain on-disk.
      *
@@ -181,6 +191,7 @@ public:
     void TransactionAddedToMempool(const CTransactionRef &);
     void BlockConnected(const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex, const std::shared_ptr<const std::vector<CTransactionRef>> &);
     void BlockDisconnected(const std::shared_ptr<const CBlock> &);
+    void BlockReceiptsConnected(const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex, const std::shared_ptr<const std::vector<TransactionReceiptInfo>> &);
     void ChainStateFlushed(const CBlockLocator &);
     void Broadcast(int64_t nBestBlockTime, CConnman* connman);
     void BlockChecked(const CBlock&, const CValidationState&);
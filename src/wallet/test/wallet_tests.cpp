@@ -377,4 +377,69 @@ BOOST_FIXTURE_TEST_CASE(wallet_disableprivkeys, TestChain100Setup)
     BOOST_CHECK(!wallet->GetKeyFromPool(pubkey, false));
 }
 
+BOOST_AUTO_TEST_CASE(stakeable_outputs)
+{
+    std::vector<CStakeableOutput> vStakeable;
+    vStakeable.emplace_back(COutPoint(InsecureRand256(), 0), 10 * COIN, 100, false);
+    vStakeable.emplace_back(COutPoint(InsecureRand256(), 1), 5 * COIN, 100, true);
+
+    // A regular output stakes after COINBASE_MATURITY confirmations,
+    // coinbase and coinstake outputs need one more.
+    int nTipHeight = 100 + COINBASE_MATURITY - 1;
+    BOOST_CHECK(vStakeable[0].IsMature(nTipHeight));
+    BOOST_CHECK(!vStakeable[1].IsMature(nTipHeight));
+    BOOST_CHECK(vStakeable[1].IsMature(nTipHeight + 1));
+    BOOST_CHECK(!vStakeable[0].IsMature(nTipHeight - 1));
+
+    // Immature coinbase outputs do not count towards the staking balance
+    BOOST_CHECK_EQUAL(CWallet::GetStakeableBalance(vStakeable, nTipHeight), 10 * COIN);
+    BOOST_CHECK_EQUAL(CWallet::GetStakeableBalance(vStakeable, nTipHeight + 1), 15 * COIN);
+}
+
+static bool HaveStakeable(const CWallet& wallet, const COutPoint& prevout)
+{
+    int nTipHeight;
+    auto vStakeable = wallet.GetStakeableCoins(nTipHeight);
+    for (const auto& output : *vStakeable) {
+        if (output.prevout == prevout)
+            return true;
+    }
+    return false;
+}
+
+BOOST_FIXTURE_TEST_CASE(stakeable_outputs_update, ListCoinsTestingSetup)
+{
+    // A confirmed send drops the spent coin and adds the confirmed change
+    const CWalletTx& wtx = AddTx(CRecipient{GetScriptForRawPubKey({}), 1 * COIN, false /* subtract fee */});
+    const COutPoint spent = wtx.tx->vin[0].prevout;
+    BOOST_CHECK(!HaveStakeable(*wallet, spent));
+    size_t nChange = 0;
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        if (wallet->IsMine(wtx.tx->vout[i]) != ISMINE_NO) {
+            BOOST_CHECK(HaveStakeable(*wallet, COutPoint(wtx.GetHash(), i)));
+            nChange++;
+        }
+    }
+    BOOST_CHECK_EQUAL(nChange, 1U);
+
+    // Committing an unbroadcast transaction drops its input, abandoning it
+    // makes the input stakeable again
+    wallet->SetBroadcastTransactions(false);
+    CTransactionRef tx;
+    CReserveKey reservekey(wallet.get());
+    CAmount fee;
+    int changePos = -1;
+    std::string error;
+    CCoinControl dummy;
+    BOOST_CHECK(wallet->CreateTransaction({CRecipient{GetScriptForRawPubKey({}), 1 * COIN, false}}, tx, reservekey, fee, changePos, error, dummy));
+    const COutPoint input = tx->vin[0].prevout;
+    BOOST_CHECK(HaveStakeable(*wallet, input));
+    CValidationState state;
+    BOOST_CHECK(wallet->CommitTransaction(tx, {}, {}, reservekey, nullptr, state));
+    BOOST_CHECK(!HaveStakeable(*wallet, input));
+
+    BOOST_CHECK(wallet->AbandonTransaction(tx->GetHash()));
+    BOOST_CHECK(HaveStakeable(*wallet, input));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
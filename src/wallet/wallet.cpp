@@ -1294,6 +1294,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             // If a transaction changes 'conflicted' state, that changes the balance
             // available of the outputs it spends. So force those to be recomputed
             MarkInputsDirty(wtx.tx);
+            UpdateStakeable(*wtx.tx);
         }
     }
 
@@ -1350,6 +1351,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
             // If a transaction changes 'conflicted' state, that changes the balance
             // available of the outputs it spends. So force those to be recomputed
             MarkInputsDirty(wtx.tx);
+            UpdateStakeable(*wtx.tx);
         }
     }
 }
@@ -1363,6 +1365,7 @@ void CWallet::SyncTransaction(const CTransactionRef& ptx, const CBlockIndex *pin
         if (tx.IsCoinStake() && IsFromMe(tx))
         {
             DisableTransaction(tx);
+            UpdateStakeable(tx);
             return;
         }
     }
@@ -1374,6 +1377,7 @@ void CWallet::SyncTransaction(const CTransactionRef& ptx, const CBlockIndex *pin
     // available of the outputs it spends. So force those to be
     // recomputed, also:
     MarkInputsDirty(ptx);
+    UpdateStakeable(*ptx);
 }
 
 void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx) {
@@ -1414,6 +1418,7 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
     }
 
     m_last_block_processed = pindex;
+    m_stakeable_tip_height = chainActive.Height();
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
@@ -1423,6 +1428,7 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
         int posInBlock = ptx->IsCoinStake() ? -1 : 0;
         SyncTransaction(ptx, nullptr, posInBlock);
     }
+    m_stakeable_tip_height = chainActive.Height();
 }
 
 
@@ -2498,45 +2504,96 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
     }
 }
 
-void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins) const
+void CWallet::UpdateStakeableOutputs(const uint256& hashTx) const
 {
-    vCoins.clear();
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
 
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-        {
-            const uint256& wtxid = it->first;
-            const CWalletTx* pcoin = &(*it).second;
-            int nDepth = pcoin->GetDepthInMainChain();
+    auto it = mapWallet.find(hashTx);
+    if (it == mapWallet.end())
+        return;
+    const CWalletTx& wtx = it->second;
+    int nDepth = wtx.GetDepthInMainChain();
+    int nHeight = chainActive.Height() - nDepth + 1;
+    bool fCoinBase = wtx.IsCoinBase() || wtx.IsCoinStake();
+
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+        const CTxOut& txout = wtx.tx->vout[i];
+        COutPoint prevout(hashTx, i);
+        mapStakeable.erase(prevout);
+        if (nDepth < 1 || txout.nValue <= 0 || IsSpent(hashTx, i) || IsMine(txout) == ISMINE_NO
+            || txout.scriptPubKey.HasOpCall() || txout.scriptPubKey.HasOpCreate())
+            continue;
+        mapStakeable.emplace(prevout, CStakeableOutput(prevout, txout.nValue, nHeight, fCoinBase));
+    }
+    m_stakeable_dirty = true;
+}
 
-            if (nDepth < 1)
-                continue;
+void CWallet::UpdateStakeable(const CTransaction& tx) const
+{
+    UpdateStakeableOutputs(tx.GetHash());
+    if (tx.IsCoinBase())
+        return;
+    for (const CTxIn& txin : tx.vin)
+        UpdateStakeableOutputs(txin.prevout.hash);
+}
 
-            if (nDepth < COINBASE_MATURITY)
-                continue;
+void CWallet::RebuildStakeable() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
 
-            if (pcoin->GetBlocksToMaturity() > 0)
-                continue;
+    mapStakeable.clear();
+    for (const auto& item : mapWallet)
+        UpdateStakeableOutputs(item.first);
+    m_stakeable_tip_height = chainActive.Height();
+    m_stakeable_stale = false;
+    m_stakeable_dirty = true;
+}
 
-            for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-                isminetype mine = IsMine(pcoin->tx->vout[i]);
-                bool solvable = IsSolvable(*this, pcoin->tx->vout[i].scriptPubKey);
-                bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && solvable);
-                if (!(IsSpent(wtxid, i)) && mine != ISMINE_NO &&
-                    !IsLockedCoin((*it).first, i) && (pcoin->tx->vout[i].nValue > 0) &&
-                    !pcoin->tx->vout[i].scriptPubKey.HasOpCall() && !pcoin->tx->vout[i].scriptPubKey.HasOpCreate())
-                        vCoins.push_back(COutput(pcoin, i, nDepth, spendable, solvable, pcoin->IsTrusted()));
-            }
+std::shared_ptr<const std::vector<CStakeableOutput> > CWallet::GetStakeableCoins(int& nTipHeight) const
+{
+    if (m_stakeable_stale) {
+        LOCK2(cs_main, cs_wallet);
+        if (m_stakeable_stale)
+            RebuildStakeable();
+    }
+
+    // Only republish when the set changed; otherwise this is lock free.
+    if (m_stakeable_dirty.exchange(false)) {
+        LOCK(cs_wallet);
+        std::shared_ptr<std::vector<CStakeableOutput> > vStakeable = std::make_shared<std::vector<CStakeableOutput> >();
+        vStakeable->reserve(mapStakeable.size());
+        for (const auto& item : mapStakeable) {
+            if (!IsLockedCoin(item.first.hash, item.first.n))
+                vStakeable->push_back(item.second);
         }
+        std::atomic_store(&m_stakeable_snapshot, std::shared_ptr<const std::vector<CStakeableOutput> >(std::move(vStakeable)));
+    }
+
+    nTipHeight = m_stakeable_tip_height;
+    return std::atomic_load(&m_stakeable_snapshot);
+}
+
+CAmount CWallet::GetStakeableBalance(const std::vector<CStakeableOutput>& vStakeable, int nTipHeight)
+{
+    CAmount nBalance = 0;
+    for (const CStakeableOutput& output : vStakeable) {
+        if (!output.fCoinBase || output.IsMature(nTipHeight))
+            nBalance += output.nValue;
     }
+    return nBalance;
 }
 
 bool CWallet::HaveAvailableCoinsForStaking() const
 {
-    std::vector<COutput> vCoins;
-    AvailableCoinsForStaking(vCoins);
-    return vCoins.size() > 0;
+    int nTipHeight = 0;
+    std::shared_ptr<const std::vector<CStakeableOutput> > vStakeable = GetStakeableCoins(nTipHeight);
+    for (const CStakeableOutput& output : *vStakeable) {
+        if (output.IsMature(nTipHeight))
+            return true;
+    }
+    return false;
 }
 
 std::map<CTxDestination, std::vector<COutput>> CWallet::ListCoins() const
@@ -2770,24 +2827,28 @@ bool CWallet::SelectCoins(const std::vector<COutput>& vAvailableCoins, const CAm
     return res;
 }
 
-bool CWallet::SelectCoinsForStaking(CAmount& nTargetValue, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, CAmount& nValueRet) const
+bool CWallet::SelectCoinsForStaking(const std::vector<CStakeableOutput>& vStakeable, int nTipHeight, CAmount& nTargetValue, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, CAmount& nValueRet) const
 {
-    std::vector<COutput> vCoins;
-    AvailableCoinsForStaking(vCoins);
-
     setCoinsRet.clear();
     nValueRet = 0;
 
-    for(COutput output : vCoins)
+    LOCK(cs_wallet);
+    for (const CStakeableOutput& output : vStakeable)
     {
-        const CWalletTx *pcoin = output.tx;
-        int i = output.i;
+        if (!output.IsMature(nTipHeight))
+            continue;
 
         // Stop if we've chosen enough inputs
         if (nValueRet >= nTargetValue)
             break;
 
-        int64_t n = pcoin->tx->vout[i].nValue;
+        auto it = mapWallet.find(output.prevout.hash);
+        if (it == mapWallet.end())
+            continue;
+        const CWalletTx *pcoin = &it->second;
+        unsigned int i = output.prevout.n;
+
+        int64_t n = output.nValue;
 
         std::pair<int64_t,std::pair<const CWalletTx*,unsigned int> > coin = std::make_pair(n,std::make_pair(pcoin, i));
 
@@ -3346,34 +3407,24 @@ bool CWallet::CreateTransaction(const std::vector<CRecipient>& vecSend, CTransac
 
 uint64_t CWallet::GetStakeWeight() const
 {
+    int nTipHeight = 0;
+    std::shared_ptr<const std::vector<CStakeableOutput> > vStakeable = GetStakeableCoins(nTipHeight);
+
     // Choose coins to use
-    CAmount nBalance = GetBalance();
+    CAmount nBalance = GetStakeableBalance(*vStakeable, nTipHeight);
 
     if (nBalance <= m_reserve_balance)
         return 0;
 
-    std::vector<const CWalletTx*> vwtxPrev;
-
     std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
     CAmount nValueIn = 0;
 
     CAmount nTargetValue = nBalance - m_reserve_balance;
-    if (!SelectCoinsForStaking(nTargetValue, setCoins, nValueIn))
-        return 0;
-
-    if (setCoins.empty())
+    if (!SelectCoinsForStaking(*vStakeable, nTipHeight, nTargetValue, setCoins, nValueIn))
         return 0;
 
-    uint64_t nWeight = 0;
-
-    LOCK2(cs_main, cs_wallet);
-    for(std::pair<const CWalletTx*,unsigned int> pcoin : setCoins)
-    {
-        if (pcoin.first->GetDepthInMainChain() >= COINBASE_MATURITY)
-            nWeight += pcoin.first->tx->vout[pcoin.second].nValue;
-    }
-
-    return nWeight;
+    // Only mature coins are selected, so every one of them counts
+    return nValueIn;
 }
 
 bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key)
@@ -3392,7 +3443,9 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, con
     txNew.vout.push_back(CTxOut(0, scriptEmpty));
 
     // Choose coins to use
-    CAmount nBalance = GetBalance();
+    int nTipHeight = 0;
+    std::shared_ptr<const std::vector<CStakeableOutput> > vStakeable = GetStakeableCoins(nTipHeight);
+    CAmount nBalance = GetStakeableBalance(*vStakeable, nTipHeight);
 
     if (nBalance <= m_reserve_balance)
         return false;
@@ -3404,17 +3457,20 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, con
 
     // Select coins with suitable depth
     CAmount nTargetValue = nBalance - m_reserve_balance;
-    if (!SelectCoinsForStaking(nTargetValue, setCoins, nValueIn))
+    if (!SelectCoinsForStaking(*vStakeable, nTipHeight, nTargetValue, setCoins, nValueIn))
         return false;
 
     if (setCoins.empty())
         return false;
 
     static std::map<COutPoint, CStakeCache> stakeCache;
-    if(stakeCache.size() > setCoins.size() + 100){
-        //Determining if the cache is still valid is harder than just clearing it when it gets too big, so instead just clear it
-        //when it has more than 100 entries more than the actual setCoins.
-        stakeCache.clear();
+    if(stakeCache.size() > setCoins.size()){
+        // Drop the entries of coins that are no longer selected
+        std::set<COutPoint> setPrevouts;
+        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+            setPrevouts.insert(COutPoint(pcoin.first->GetHash(), pcoin.second));
+        for(auto it = stakeCache.begin(); it != stakeCache.end();)
+            it = setPrevouts.count(it->first) ? std::next(it) : stakeCache.erase(it);
     }
     if(gArgs.GetBoolArg("-stakecache", DEFAULT_STAKE_CACHE)) {
 
@@ -3611,6 +3667,7 @@ bool CWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::ve
             // Add tx to wallet, because if it has change it's also ours,
             // otherwise just for transaction history.
             AddToWallet(wtxNew);
+            UpdateStakeable(*wtxNew.tx);
 
             // Notify that old coins are spent
             for (const CTxIn& txin : wtxNew.tx->vin)
@@ -3679,6 +3736,7 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
         mapWallet.erase(it);
     }
+    m_stakeable_stale = true;
 
     if (nZapSelectTxRet == DBErrors::NEED_REWRITE)
     {
@@ -3722,6 +3780,7 @@ DBErrors CWallet::ZapWalletTx(std::vector<CWalletTx>& vWtx)
     if (nZapWalletTxRet != DBErrors::LOAD_OK)
         return nZapWalletTxRet;
 
+    m_stakeable_stale = true;
     return DBErrors::LOAD_OK;
 }
 
@@ -4267,18 +4326,21 @@ void CWallet::LockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.insert(output);
+    m_stakeable_dirty = true;
 }
 
 void CWallet::UnlockCoin(const COutPoint& output)
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.erase(output);
+    m_stakeable_dirty = true;
 }
 
 void CWallet::UnlockAllCoins()
 {
     AssertLockHeld(cs_wallet); // setLockedCoins
     setLockedCoins.clear();
+    m_stakeable_dirty = true;
 }
 
 bool CWallet::IsLockedCoin(uint256 hash, unsigned int n) const
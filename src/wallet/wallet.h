@@ -7,6 +7,7 @@
 #define BITCOIN_WALLET_WALLET_H
 
 #include <amount.h>
+#include <consensus/consensus.h>
 #include <outputtype.h>
 #include <policy/feerate.h>
 #include <streams.h>
@@ -533,6 +534,25 @@ public:
     std::set<uint256> GetConflicts() const;
 };
 
+/** A confirmed, unspent wallet output the staker may use once it is mature */
+struct CStakeableOutput
+{
+    COutPoint prevout;
+    CAmount nValue;
+    //! height of the block containing the transaction
+    int nHeight;
+    //! coinbase or coinstake output, needs one extra confirmation
+    bool fCoinBase;
+
+    CStakeableOutput(const COutPoint& prevoutIn, CAmount nValueIn, int nHeightIn, bool fCoinBaseIn)
+        : prevout(prevoutIn), nValue(nValueIn), nHeight(nHeightIn), fCoinBase(fCoinBaseIn) {}
+
+    bool IsMature(int nTipHeight) const
+    {
+        return nTipHeight - nHeight + 1 >= COINBASE_MATURITY + (fCoinBase ? 1 : 0);
+    }
+};
+
 class COutput
 {
 public:
@@ -677,6 +697,26 @@ protected:
     /* Mark a transaction's inputs dirty, thus forcing the outputs to be recomputed */
     void MarkInputsDirty(const CTransactionRef& tx);
 
+    /**
+     * Stakeable outputs, keyed by outpoint. Kept up to date as transactions
+     * are synced, abandoned or conflicted so the staker never has to scan
+     * mapWallet. Locked coins are filtered out when the snapshot is built.
+     */
+    mutable std::map<COutPoint, CStakeableOutput> mapStakeable GUARDED_BY(cs_wallet);
+    //! published copy of mapStakeable, read with std::atomic_load
+    mutable std::shared_ptr<const std::vector<CStakeableOutput> > m_stakeable_snapshot;
+    //! mapStakeable changed since the snapshot was published
+    mutable std::atomic<bool> m_stakeable_dirty{true};
+    //! mapStakeable must be rebuilt from mapWallet (on load and after zapping)
+    mutable std::atomic<bool> m_stakeable_stale{true};
+    //! chain height the stakeable set was last updated against
+    mutable std::atomic<int> m_stakeable_tip_height{0};
+
+    /* Recompute the stakeable outputs of a transaction and of the transactions it spends */
+    void UpdateStakeable(const CTransaction& tx) const EXCLUSIVE_LOCKS_REQUIRED(cs_main, cs_wallet);
+    void UpdateStakeableOutputs(const uint256& hashTx) const EXCLUSIVE_LOCKS_REQUIRED(cs_main, cs_wallet);
+    void RebuildStakeable() const EXCLUSIVE_LOCKS_REQUIRED(cs_main, cs_wallet);
+
     virtual void SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator>);
 
     /* Used by TransactionAddedToMemorypool/BlockConnected/Disconnected/ScanForWalletTransactions.
@@ -812,12 +852,15 @@ public:
     bool CanSupportFeature(enum WalletFeature wf) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { AssertLockHeld(cs_wallet); return nWalletMaxVersion >= wf; }
 
     //! select coins for staking from the available coins for staking.
-    bool SelectCoinsForStaking(CAmount& nTargetValue, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, CAmount& nValueRet) const;
-	
+    bool SelectCoinsForStaking(const std::vector<CStakeableOutput>& vStakeable, int nTipHeight, CAmount& nTargetValue, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, CAmount& nValueRet) const;
+
     /**
-     * populate vCoins with vector of available COutputs.
+     * Snapshot of the outputs that can stake, without taking cs_main.
+     * Only takes cs_wallet when the set changed since the last call.
      */
-    void AvailableCoinsForStaking(std::vector<COutput>& vCoins) const;
+    std::shared_ptr<const std::vector<CStakeableOutput> > GetStakeableCoins(int& nTipHeight) const;
+    //! balance the staker works with: stakeable outputs less immature coinbase and coinstake
+    static CAmount GetStakeableBalance(const std::vector<CStakeableOutput>& vStakeable, int nTipHeight);
     virtual void AvailableCoins(std::vector<COutput>& vCoins, bool fOnlySafe=true, const CCoinControl *coinControl = nullptr, const CAmount& nMinimumAmount = 1, const CAmount& nMaximumAmount = MAX_MONEY, const CAmount& nMinimumSumAmount = MAX_MONEY, const uint64_t nMaximumCount = 0, const int nMinDepth = 0, const int nMaxDepth = 9999999, bool fIncludeImmature=false) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool HaveAvailableCoinsForStaking() const;
 
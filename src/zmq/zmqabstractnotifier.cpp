@@ -20,3 +20,13 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyReceipt(const TransactionReceiptInfo &/*receipt*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyKeyImages(const CTransaction &/*transaction*/, bool /*fConnected*/)
+{
+    return true;
+}
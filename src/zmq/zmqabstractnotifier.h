@@ -9,6 +9,7 @@
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
+struct TransactionReceiptInfo;
 
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 
@@ -34,6 +35,9 @@ public:
 
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    virtual bool NotifyReceipt(const TransactionReceiptInfo &receipt);
+    // fConnected is false when the transaction's block is disconnected
+    virtual bool NotifyKeyImages(const CTransaction &transaction, bool fConnected);
 
 protected:
     void *psocket;
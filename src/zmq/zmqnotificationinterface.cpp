@@ -48,6 +48,9 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubrawreceipt"] = CZMQAbstractNotifier::Create<CZMQPublishRawReceiptNotifier>;
+    factories["publogs"] = CZMQAbstractNotifier::Create<CZMQPublishLogsNotifier>;
+    factories["pubkeyimage"] = CZMQAbstractNotifier::Create<CZMQPublishKeyImageNotifier>;
 
     for (const auto& entry : factories)
     {
@@ -60,6 +63,17 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
             notifier->SetType(entry.first);
             notifier->SetAddress(address);
             notifiers.push_back(notifier);
+
+            if (entry.first == "publogs") {
+                // Values were checked in AppInitParameterInteraction
+                std::set<dev::h160> addresses;
+                for (const std::string& strAddress : gArgs.GetArgs("-zmqpublogsaddress"))
+                    addresses.insert(dev::h160(ParseHex(strAddress)));
+                std::set<dev::h256> topics;
+                for (const std::string& strTopic : gArgs.GetArgs("-zmqpublogstopic"))
+                    topics.insert(dev::h256(ParseHex(strTopic)));
+                static_cast<CZMQPublishLogsNotifier*>(notifier)->SetFilter(addresses, topics);
+            }
         }
     }
 
@@ -174,12 +188,35 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     }
 }
 
+void CZMQNotificationInterface::KeyImagesUpdated(const CBlock& block, bool fConnected)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        bool fOk = true;
+        for (const CTransactionRef& ptx : block.vtx) {
+            if (!(fOk = notifier->NotifyKeyImages(*ptx, fConnected)))
+                break;
+        }
+        if (fOk)
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
 void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted)
 {
     for (const CTransactionRef& ptx : pblock->vtx) {
         // Do a normal notify for each transaction added in the block
         TransactionAddedToMempool(ptx);
     }
+    KeyImagesUpdated(*pblock, true);
 }
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock)
@@ -188,6 +225,29 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
         // Do a normal notify for each transaction removed in block disconnection
         TransactionAddedToMempool(ptx);
     }
+    KeyImagesUpdated(*pblock, false);
+}
+
+void CZMQNotificationInterface::BlockReceiptsConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<TransactionReceiptInfo>& receipts)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        bool fOk = true;
+        for (const TransactionReceiptInfo& receipt : receipts) {
+            if (!(fOk = notifier->NotifyReceipt(receipt)))
+                break;
+        }
+        if (fOk)
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
 }
 
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
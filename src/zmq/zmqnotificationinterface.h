@@ -30,11 +30,14 @@ protected:
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
+    void BlockReceiptsConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<TransactionReceiptInfo>& receipts) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
 
 private:
     CZMQNotificationInterface();
 
+    void KeyImagesUpdated(const CBlock& block, bool fConnected);
+
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
 };
@@ -10,12 +10,17 @@
 #include <util.h>
 #include <rpc/server.h>
 
+#include <algorithm>
+
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
 static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_RAWRECEIPT = "rawreceipt";
+static const char *MSG_LOG       = "log";
+static const char *MSG_KEYIMAGE  = "keyimage";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -195,3 +200,88 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+template <unsigned N>
+static void WriteFixedHash(CDataStream &ss, const dev::FixedHash<N> &h)
+{
+    ss.write((const char*)h.data(), N);
+}
+
+static void SerializeLogEntry(CDataStream &ss, const dev::eth::LogEntry &log)
+{
+    WriteFixedHash(ss, log.address);
+    WriteCompactSize(ss, log.topics.size());
+    for (const dev::h256 &topic : log.topics)
+        WriteFixedHash(ss, topic);
+    ss << log.data;
+}
+
+bool CZMQPublishRawReceiptNotifier::NotifyReceipt(const TransactionReceiptInfo &receipt)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawreceipt %s\n", receipt.transactionHash.GetHex());
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << receipt.blockHash << receipt.blockNumber << receipt.transactionHash << receipt.transactionIndex;
+    WriteFixedHash(ss, receipt.from);
+    WriteFixedHash(ss, receipt.to);
+    ss << receipt.cumulativeGasUsed << receipt.gasUsed;
+    WriteFixedHash(ss, receipt.contractAddress);
+    ss << (uint32_t)receipt.excepted;
+    WriteCompactSize(ss, receipt.logs.size());
+    for (const dev::eth::LogEntry &log : receipt.logs)
+        SerializeLogEntry(ss, log);
+    return SendMessage(MSG_RAWRECEIPT, &(*ss.begin()), ss.size());
+}
+
+void CZMQPublishLogsNotifier::SetFilter(const std::set<dev::h160> &addresses, const std::set<dev::h256> &topics)
+{
+    setAddresses = addresses;
+    setTopics = topics;
+}
+
+bool CZMQPublishLogsNotifier::NotifyReceipt(const TransactionReceiptInfo &receipt)
+{
+    for (uint32_t i = 0; i < receipt.logs.size(); i++) {
+        const dev::eth::LogEntry &log = receipt.logs[i];
+        if (!setAddresses.empty() && !setAddresses.count(log.address))
+            continue;
+        if (!setTopics.empty() && std::none_of(log.topics.begin(), log.topics.end(),
+                [this](const dev::h256 &topic) { return setTopics.count(topic) != 0; }))
+            continue;
+
+        LogPrint(BCLog::ZMQ, "zmq: Publish log %s:%u\n", receipt.transactionHash.GetHex(), i);
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << receipt.blockHash << receipt.blockNumber << receipt.transactionHash << receipt.transactionIndex << i;
+        SerializeLogEntry(ss, log);
+        if (!SendMessage(MSG_LOG, &(*ss.begin()), ss.size()))
+            return false;
+    }
+    return true;
+}
+
+bool CZMQPublishKeyImageNotifier::NotifyKeyImages(const CTransaction &transaction, bool fConnected)
+{
+    uint256 hash = transaction.GetHash();
+    for (const CTxIn &txin : transaction.vin) {
+        if (!txin.IsAnonInput())
+            continue;
+        uint32_t nInputs, nRingSize;
+        txin.GetAnonInfo(nInputs, nRingSize);
+        // The block was validated, but don't trust the layout blindly
+        if (txin.scriptData.stack.size() != 1 || txin.scriptData.stack[0].size() != 33 * nInputs)
+            continue;
+
+        const std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+        for (size_t k = 0; k < nInputs; ++k) {
+            LogPrint(BCLog::ZMQ, "zmq: Publish keyimage %s %s\n", HexStr(&vKeyImages[k * 33], &vKeyImages[k * 33] + 33), fConnected ? "spent" : "unspent");
+            /* key image, txid in hashtx byte order, 1 if spent or 0 if the spend was disconnected */
+            unsigned char data[33 + 32 + 1];
+            memcpy(data, &vKeyImages[k * 33], 33);
+            for (unsigned int i = 0; i < 32; i++)
+                data[33 + 31 - i] = hash.begin()[i];
+            data[65] = fConnected ? 1 : 0;
+            if (!SendMessage(MSG_KEYIMAGE, data, sizeof(data)))
+                return false;
+        }
+    }
+    return true;
+}
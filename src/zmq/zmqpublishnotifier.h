@@ -7,6 +7,10 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <uint256.h>
+
+#include <set>
+
 class CBlockIndex;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
@@ -52,4 +56,29 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishRawReceiptNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyReceipt(const TransactionReceiptInfo &receipt) override;
+};
+
+class CZMQPublishLogsNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    //! Publish only logs emitted by one of these contracts, if not empty
+    std::set<dev::h160> setAddresses;
+    //! Publish only logs carrying one of these topics, if not empty
+    std::set<dev::h256> setTopics;
+
+public:
+    void SetFilter(const std::set<dev::h160> &addresses, const std::set<dev::h256> &topics);
+    bool NotifyReceipt(const TransactionReceiptInfo &receipt) override;
+};
+
+class CZMQPublishKeyImageNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyKeyImages(const CTransaction &transaction, bool fConnected) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
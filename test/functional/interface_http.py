@@ -5,7 +5,7 @@
 """Test the RPC HTTP basics."""
 
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, str_to_b64str
+from test_framework.util import assert_equal, str_to_b64str, wait_until
 
 import http.client
 import urllib.parse
@@ -13,6 +13,7 @@ import urllib.parse
 class HTTPBasicsTest (BitcoinTestFramework):
     def set_test_params(self):
         self.num_nodes = 3
+        self.extra_args = [[], ["-rpcworklane=fast:1:4:getblockcount,/rest/"], []]
 
     def setup_network(self):
         self.setup_nodes()
@@ -103,6 +104,19 @@ class HTTPBasicsTest (BitcoinTestFramework):
         out1 = conn.getresponse()
         assert_equal(out1.status, http.client.BAD_REQUEST)
 
+        # Requests are routed to their work lane
+        queues = self.nodes[1].getrpcworkqueues()
+        assert_equal(len(queues['bounds']) + 1, len(queues['queues'][0]['runtime']))
+        assert_equal([q['name'] for q in queues['queues']], ['default', 'fast'])
+        assert_equal(queues['queues'][1]['threads'], 1)
+        assert_equal(queues['queues'][1]['maxdepth'], 4)
+        self.nodes[1].getblockcount()
+        self.nodes[1].getbestblockhash()
+        wait_until(lambda: self.nodes[1].getrpcworkqueues()['queues'][1]['processed'] == 1, timeout=10)
+        lane = self.nodes[1].getrpcworkqueues()['queues'][1]
+        assert_equal(sum(lane['waittime']), 1)
+        assert_equal(lane['rejected'], 0)
+
 
 if __name__ == '__main__':
     HTTPBasicsTest ().main ()
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+# Copyright (c) 2018 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test JSON-RPC batches, executed serially and with -rpcbatchconcurrency."""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+class RPCInterfaceTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [[], ["-rpcbatchconcurrency=4"]]
+
+    def check_batch(self, node):
+        height = node.getblockcount()
+        calls = [node.getblockhash.get_request(h) for h in range(height + 1)]
+        # A method that is not executed concurrently splits the batch
+        calls.insert(5, node.getconnectioncount.get_request())
+        # Errors are reported in place
+        calls.append(node.getblockhash.get_request(height + 1))
+        calls.append({'version': '1.1', 'method': 'nosuchmethod', 'params': [], 'id': 'unknown'})
+
+        results = node.batch(calls)
+        assert_equal(len(results), len(calls))
+        for call, result in zip(calls, results):
+            assert_equal(result['id'], call['id'])
+        for h in range(height + 1):
+            result = results[h if h < 5 else h + 1]
+            assert_equal(result['error'], None)
+            assert_equal(result['result'], node.getblockhash(h))
+        assert_equal(results[5]['result'], node.getconnectioncount())
+        assert_equal(results[-2]['error']['code'], -8)
+        assert_equal(results[-1]['error']['code'], -32601)
+
+    def run_test(self):
+        self.log.info("Testing serial batch execution")
+        self.check_batch(self.nodes[0])
+        self.log.info("Testing concurrent batch execution")
+        self.check_batch(self.nodes[1])
+
+if __name__ == '__main__':
+    RPCInterfaceTest().main()